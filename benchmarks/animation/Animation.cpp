@@ -0,0 +1,121 @@
+#include <hyprutils/animation/AnimationConfig.hpp>
+#include <hyprutils/animation/AnimationManager.hpp>
+#include <hyprutils/animation/AnimatedVariable.hpp>
+#include <hyprutils/memory/UniquePtr.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace Hyprutils::Animation;
+using namespace Hyprutils::Math;
+using namespace Hyprutils::Memory;
+
+constexpr size_t VARIABLES = 10000;
+constexpr size_t TICKS     = 200;
+
+enum eBenchTypes : uint8_t {
+    BENCH_FLOAT = 0,
+    BENCH_VECTOR,
+};
+
+struct SEmptyContext {};
+
+template <typename T>
+using CAnimatedVariable = CGenericAnimatedVariable<T, SEmptyContext>;
+
+class CBenchAnimationManager : public CAnimationManager {
+  public:
+    // what a consumer writes without tick(), one variable at a time
+    void tickByHand() {
+        for (const auto& PAV : m_vActiveAnimatedVariables) {
+            if (!PAV || !PAV->ok() || !PAV->isBeingAnimated())
+                continue;
+
+            const auto SPENT   = PAV->getPercent();
+            const auto PBEZIER = getBezier(PAV->getBezierName());
+
+            if (SPENT >= 1.f || !PAV->enabled()) {
+                PAV->warp(true, false);
+                continue;
+            }
+
+            const auto POINTY = PBEZIER->getYForPoint(SPENT);
+
+            switch (PAV->m_Type) {
+                case BENCH_FLOAT: {
+                    auto* av     = dc<CAnimatedVariable<float>*>(PAV.get());
+                    av->value() = av->begun() + ((av->goal() - av->begun()) * POINTY);
+                } break;
+                case BENCH_VECTOR: {
+                    auto* av     = dc<CAnimatedVariable<Vector2D>*>(PAV.get());
+                    av->value() = av->begun() + ((av->goal() - av->begun()) * POINTY);
+                } break;
+                default: break;
+            }
+
+            PAV->onUpdate();
+        }
+
+        tickDone();
+    }
+
+    virtual void scheduleTick() {
+        ;
+    }
+
+    virtual void onTicked() {
+        ;
+    }
+};
+
+// 10k variables, half floats and half vectors, all animating for the whole run
+static void benchTick(const char* name, bool builtIn) {
+    CAnimationConfigTree tree;
+    tree.createNode("bench");
+    // long enough to never end while measuring
+    tree.setConfigForNode("bench", 1, 1000000.f, "default");
+
+    CBenchAnimationManager manager;
+    manager.setTickHandler<float, SEmptyContext>(BENCH_FLOAT);
+    manager.setTickHandler<Vector2D, SEmptyContext>(BENCH_VECTOR);
+
+    std::vector<CUniquePointer<CAnimatedVariable<float>>>    floats;
+    std::vector<CUniquePointer<CAnimatedVariable<Vector2D>>> vectors;
+    size_t                                                   updates = 0;
+
+    for (size_t i = 0; i < VARIABLES / 2; ++i) {
+        auto& f = floats.emplace_back(makeUnique<CAnimatedVariable<float>>());
+        f->create2(BENCH_FLOAT, &manager, f, 0.f);
+        f->setConfig(tree.getConfig("bench"));
+        f->setUpdateCallback([&updates](auto) { updates++; });
+        *f = 1.f;
+
+        auto& v = vectors.emplace_back(makeUnique<CAnimatedVariable<Vector2D>>());
+        v->create2(BENCH_VECTOR, &manager, v, Vector2D{});
+        v->setConfig(tree.getConfig("bench"));
+        v->setUpdateCallback([&updates](auto) { updates++; });
+        *v = Vector2D{100, 100};
+    }
+
+    const auto BEGIN = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < TICKS; ++i) {
+        if (builtIn)
+            manager.tick();
+        else
+            manager.tickByHand();
+    }
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%-31s %10.2f us/tick %8.2f ns/variable\n", name, (double)NS / TICKS / 1000, (double)NS / (TICKS * VARIABLES));
+
+    if (updates != TICKS * VARIABLES)
+        std::printf("unexpected result %zu\n", updates);
+}
+
+int main() {
+    benchTick("10k variables, by hand", false);
+    benchTick("10k variables, tick()", true);
+
+    return 0;
+}
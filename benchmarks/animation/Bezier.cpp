@@ -0,0 +1,58 @@
+#include <hyprutils/animation/BezierCurve.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace Hyprutils::Animation;
+using namespace Hyprutils::Math;
+
+constexpr size_t POINTS = 10000;
+constexpr size_t ROUNDS = 1000;
+
+// the progress of 10k variables that started at different times
+static std::vector<float> makePoints() {
+    std::vector<float> points(POINTS);
+    for (size_t i = 0; i < POINTS; ++i) {
+        points[i] = (float)((i * 7919) % POINTS) / POINTS;
+    }
+    return points;
+}
+
+static void benchCurve(const char* name, const Vector2D& p1, const Vector2D& p2) {
+    CBezierCurve curve;
+    curve.setup({p1, p2});
+
+    const auto         POINTS_X = makePoints();
+    std::vector<float> ys(POINTS);
+    float              sum = 0;
+
+    auto               begin = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < POINTS; ++i) {
+            ys[i] = curve.getYForPoint(POINTS_X[i]);
+        }
+        sum += ys[round % POINTS];
+    }
+    const auto SCALAR_NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        curve.getYForPoints(POINTS_X, ys);
+        sum += ys[round % POINTS];
+    }
+    const auto BATCH_NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    std::printf("%-31s %8.2f ns/point getYForPoint %8.2f ns/point getYForPoints\n", name, (double)SCALAR_NS / (ROUNDS * POINTS), (double)BATCH_NS / (ROUNDS * POINTS));
+
+    if (sum < 0)
+        std::printf("unexpected result %f\n", sum);
+}
+
+int main() {
+    benchCurve("default", {0.0, 0.75}, {0.15, 1.0});
+    benchCurve("easeInOut", {0.42, 0.0}, {0.58, 1.0});
+    benchCurve("overshot", {0.05, 0.9}, {0.1, 1.05});
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <hyprutils/memory/Atomic.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+#define ASP CAtomicSharedPointer
+#define AWP CAtomicWeakPointer
+
+constexpr size_t ITERATIONS = 1000000;
+
+template <typename Fn>
+static void bench(const char* name, size_t threadCount, Fn&& fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+
+    const auto BEGIN = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(fn);
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%-16s %2zu threads %8.2f ns/op\n", name, threadCount, (double)NS / (ITERATIONS * threadCount));
+}
+
+int main() {
+    auto     shared = makeAtomicShared<int>(0);
+    AWP<int> weak   = shared;
+
+    for (size_t threads : {1, 2, 4, 8}) {
+        bench("copy+reset", threads, [&shared] {
+            for (size_t i = 0; i < ITERATIONS; ++i) {
+                ASP<int> copy = shared;
+                copy.reset();
+            }
+        });
+
+        bench("weak lock", threads, [&weak] {
+            for (size_t i = 0; i < ITERATIONS; ++i) {
+                auto locked = weak.lock();
+            }
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <hyprutils/memory/Atomic.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+#define ASP CAtomicSharedPointer
+
+struct SSnapshot {
+    size_t gen = 0;
+};
+
+constexpr auto DURATION = std::chrono::milliseconds(500);
+
+// 1 writer publishing snapshots as fast as it can, N readers loading them
+template <typename Load, typename Store>
+static void bench(const char* name, size_t readerCount, Load&& load, Store&& store) {
+    std::atomic<bool>        done   = false;
+    std::atomic<size_t>      reads  = 0;
+    std::atomic<size_t>      writes = 0;
+    std::vector<std::thread> threads;
+
+    threads.reserve(readerCount + 1);
+    for (size_t i = 0; i < readerCount; ++i) {
+        threads.emplace_back([&] {
+            size_t n = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                auto snapshot = load();
+                n += !!snapshot;
+            }
+            reads += n;
+        });
+    }
+
+    threads.emplace_back([&] {
+        size_t n = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            store(makeAtomicShared<SSnapshot>(++n));
+        }
+        writes += n;
+    });
+
+    std::this_thread::sleep_for(DURATION);
+    done = true;
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const auto MS = std::chrono::duration_cast<std::chrono::milliseconds>(DURATION).count();
+    std::printf("%-8s %2zu readers %10.0f reads/ms %8.0f writes/ms\n", name, readerCount, (double)reads / MS, (double)writes / MS);
+}
+
+int main() {
+    for (size_t readers : {1, 2, 4, 8}) {
+        CAtomicSharedSlot<SSnapshot> slot(makeAtomicShared<SSnapshot>());
+        bench("slot", readers, [&] { return slot.load(); }, [&](ASP<SSnapshot>&& s) { slot.store(std::move(s)); });
+
+        std::mutex     mutex;
+        ASP<SSnapshot> locked = makeAtomicShared<SSnapshot>();
+        bench(
+            "mutex", readers,
+            [&] {
+                std::lock_guard lg(mutex);
+                return locked;
+            },
+            [&](ASP<SSnapshot>&& s) {
+                std::lock_guard lg(mutex);
+                locked = std::move(s);
+            });
+    }
+
+    return 0;
+}
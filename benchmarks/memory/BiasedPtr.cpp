@@ -0,0 +1,31 @@
+#include <hyprutils/memory/Atomic.hpp>
+#include <hyprutils/memory/BiasedPtr.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace Hyprutils::Memory;
+
+constexpr size_t ITERATIONS = 10000000;
+
+template <typename Ptr>
+static void bench(const char* name, const Ptr& ptr) {
+    const auto BEGIN = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        Ptr copy = ptr;
+        asm volatile("" : : "r"(&copy) : "memory");
+    }
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%-24s %6.2f ns/copy\n", name, (double)NS / ITERATIONS);
+}
+
+// copies on the owner thread, which is the case the biased pointers are for
+int main() {
+    bench("CSharedPointer", makeShared<int>(0));
+    bench("CAtomicSharedPointer", makeAtomicShared<int>(0));
+    bench("CBiasedSharedPointer", makeBiasedShared<int>(0));
+
+    return 0;
+}
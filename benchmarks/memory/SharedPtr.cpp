@@ -0,0 +1,169 @@
+#include <hyprutils/memory/Allocator.hpp>
+#include <hyprutils/memory/FrameArena.hpp>
+#include <hyprutils/memory/ObjectPool.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/UniquePtr.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+#define SP CSharedPointer
+#define WP CWeakPointer
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+struct SPayload {
+    int    a = 0;
+    double b = 0;
+    void*  c = nullptr;
+};
+
+constexpr size_t OBJECTS = 1000000;
+
+template <typename Fn>
+static void bench(const char* name, Fn&& fn) {
+    g_allocations = 0;
+
+    const auto BEGIN = std::chrono::steady_clock::now();
+    fn();
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%-32s %8.2f ns/obj %6.2f allocs/obj\n", name, (double)NS / OBJECTS, (double)g_allocations / OBJECTS);
+}
+
+int main() {
+    std::vector<SP<SPayload>> shared;
+    std::vector<WP<SPayload>> weak;
+    shared.reserve(OBJECTS);
+    weak.reserve(OBJECTS);
+
+    bench("SP(new T) create+destroy", [&] {
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            shared.emplace_back(SP<SPayload>(new SPayload()));
+        }
+        shared.clear();
+    });
+
+    bench("makeShared create+destroy", [&] {
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            shared.emplace_back(makeShared<SPayload>());
+        }
+        shared.clear();
+    });
+
+    bench("SP(new T) with weak refs", [&] {
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            shared.emplace_back(SP<SPayload>(new SPayload()));
+            weak.emplace_back(shared.back());
+        }
+        shared.clear();
+        weak.clear();
+    });
+
+    bench("makeShared with weak refs", [&] {
+        for (size_t i = 0; i < OBJECTS; ++i) {
+            shared.emplace_back(makeShared<SPayload>());
+            weak.emplace_back(shared.back());
+        }
+        shared.clear();
+        weak.clear();
+    });
+
+    // deref through the control block, this is where the fused layout saves a cache line
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        shared.emplace_back(SP<SPayload>(new SPayload()));
+    }
+
+    bench("SP(new T) deref", [&] {
+        for (auto& s : shared) {
+            s->a++;
+        }
+    });
+
+    shared.clear();
+    for (size_t i = 0; i < OBJECTS; ++i) {
+        shared.emplace_back(makeShared<SPayload>());
+    }
+
+    bench("makeShared deref", [&] {
+        for (auto& s : shared) {
+            s->a++;
+        }
+    });
+
+    // per-frame objects, freed in bulk at the end of each frame
+    constexpr size_t FRAMES = 100;
+    CFrameArena      arena;
+    shared.clear();
+
+    bench("makeShared per frame", [&] {
+        for (size_t f = 0; f < FRAMES; ++f) {
+            for (size_t i = 0; i < OBJECTS / FRAMES; ++i) {
+                shared.emplace_back(makeShared<SPayload>());
+            }
+            shared.clear();
+        }
+    });
+
+    bench("allocateShared(arena) per frame", [&] {
+        for (size_t f = 0; f < FRAMES; ++f) {
+            for (size_t i = 0; i < OBJECTS / FRAMES; ++i) {
+                shared.emplace_back(allocateShared<SPayload>(&arena));
+            }
+            shared.clear();
+            arena.reset();
+        }
+    });
+
+    // the same churn through unique pointers, recycled by a pool
+    std::vector<CUniquePointer<SPayload>> unique;
+    unique.reserve(OBJECTS / FRAMES);
+    CObjectPool<SPayload> objectPool({.maxIdle = OBJECTS / FRAMES});
+
+    bench("makeUnique per frame", [&] {
+        for (size_t f = 0; f < FRAMES; ++f) {
+            for (size_t i = 0; i < OBJECTS / FRAMES; ++i) {
+                unique.emplace_back(makeUnique<SPayload>());
+            }
+            unique.clear();
+        }
+    });
+
+    bench("CObjectPool per frame", [&] {
+        for (size_t f = 0; f < FRAMES; ++f) {
+            for (size_t i = 0; i < OBJECTS / FRAMES; ++i) {
+                unique.emplace_back(objectPool.acquire());
+            }
+            unique.clear();
+        }
+    });
+
+    const auto pool = getControlBlockPoolStats();
+    if (pool.enabled)
+        std::printf("control block pool: %zu hits, %zu misses, %zu slabs\n", pool.hits, pool.misses, pool.slabs);
+    else
+        std::printf("control block pool: disabled\n");
+
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include <hyprutils/signal/Signal.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#include <poll.h>
+
+using namespace Hyprutils::Signal;
+using namespace Hyprutils::Memory;
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+constexpr size_t CALLS = 10000000;
+
+static void benchEmit(size_t listenerCount, size_t staticCount) {
+    CSignalT<int>                    signal;
+    std::vector<CHyprSignalListener> listeners;
+    size_t                           sum = 0;
+
+    for (size_t i = 0; i < listenerCount; ++i) {
+        listeners.emplace_back(signal.listen([&sum](int v) { sum += v; }));
+    }
+
+    for (size_t i = 0; i < staticCount; ++i) {
+        signal.listenStatic([&sum](int v) { sum += v; });
+    }
+
+    // the same amount of handler calls for every listener count
+    const size_t EMITS = CALLS / std::max<size_t>(listenerCount + staticCount, 1);
+
+    // warm up, anything allocated once is not what we're after
+    signal.emit(1);
+
+    g_allocations    = 0;
+    const auto BEGIN = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < EMITS; ++i) {
+        signal.emit(1);
+    }
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%5zu listeners %5zu static %10.2f ns/emit %8.2f ns/call %6.2f allocs/emit\n", listenerCount, staticCount, (double)NS / EMITS,
+                (double)NS / (EMITS * std::max<size_t>(listenerCount + staticCount, 1)), (double)g_allocations / EMITS);
+
+    if (sum != (EMITS + 1) * (listenerCount + staticCount))
+        std::printf("unexpected result %zu\n", sum);
+}
+
+// 1000 listeners on different ids, each emit is meant for one of them
+static void benchKeyed() {
+    constexpr size_t                 LISTENERS = 1000;
+    constexpr size_t                 EMITS     = CALLS / 100;
+    size_t                           sum       = 0;
+
+    CSignalT<uint32_t, int>          broadcast;
+    CKeyedSignalT<uint32_t, int>     keyed;
+    std::vector<CHyprSignalListener> listeners;
+
+    for (uint32_t id = 0; id < LISTENERS; ++id) {
+        listeners.emplace_back(broadcast.listen([&sum, id](uint32_t target, int v) {
+            if (target == id)
+                sum += v;
+        }));
+        listeners.emplace_back(keyed.listen(id, [&sum](int v) { sum += v; }));
+    }
+
+    const auto run = [&](const char* name, auto&& emit) {
+        g_allocations    = 0;
+        const auto BEGIN = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < EMITS; ++i) {
+            emit(sc<uint32_t>(i % LISTENERS));
+        }
+        const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+        std::printf("%-31s %10.2f ns/emit %6.2f allocs/emit\n", name, (double)NS / EMITS, (double)g_allocations / EMITS);
+    };
+
+    run("1000 ids, broadcast + filter", [&](uint32_t id) { broadcast.emit(id, 1); });
+    run("1000 ids, CKeyedSignalT", [&](uint32_t id) { keyed.emit(id, 1); });
+
+    if (sum != 2 * EMITS)
+        std::printf("unexpected result %zu\n", sum);
+}
+
+// short-lived listeners next to a steady set of long-lived ones
+static void benchChurn() {
+    constexpr size_t                 LONG_LIVED = 1000;
+    constexpr size_t                 CHURN      = CALLS / 100;
+
+    CSignalT<>                       signal;
+    std::vector<CHyprSignalListener> listeners;
+
+    for (size_t i = 0; i < LONG_LIVED; ++i) {
+        listeners.emplace_back(signal.listen([] {}));
+    }
+
+    const auto BEGIN = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < CHURN; ++i) {
+        auto shortLived = signal.listen([] {});
+    }
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%-31s %10.2f ns/listener\n", "listen+drop next to 1000", (double)NS / CHURN);
+}
+
+// many emits per frame, drained by one flush
+static void benchDeferred() {
+    constexpr size_t      PER_FRAME = 100;
+    constexpr size_t      FRAMES    = CALLS / PER_FRAME;
+    size_t                sum       = 0;
+
+    CDeferredSignalT<int> all;
+    CDeferredSignalT<int> last(DEFER_KEEP_LAST);
+    auto                  l1 = all.listen([&sum](int v) { sum += v; });
+    auto                  l2 = last.listen([&sum](int v) { sum += v; });
+
+    const auto            run = [&](const char* name, CDeferredSignalT<int>& signal) {
+        // warm up, the queue keeps its storage between frames
+        signal.emit(0);
+        signal.flush();
+
+        g_allocations    = 0;
+        const auto BEGIN = std::chrono::steady_clock::now();
+        for (size_t frame = 0; frame < FRAMES; ++frame) {
+            for (size_t i = 0; i < PER_FRAME; ++i) {
+                signal.emit(1);
+            }
+            signal.flush();
+        }
+        const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+        std::printf("%-31s %10.2f ns/emit %6.2f allocs/emit\n", name, (double)NS / CALLS, (double)g_allocations / CALLS);
+    };
+
+    run("deferred, 100/frame, keep all", all);
+    run("deferred, 100/frame, keep last", last);
+
+    if (sum != CALLS + FRAMES)
+        std::printf("unexpected result %zu\n", sum);
+}
+
+// a chain of 100 input handlers where the one in front takes the event
+static void benchConsumable() {
+    constexpr size_t                 HANDLERS = 100;
+    constexpr size_t                 EMITS    = CALLS / 100;
+    size_t                           handled  = 0;
+
+    CSignalT<bool&>                  flagged;
+    CConsumableSignalT<>             consumable;
+    std::vector<CHyprSignalListener> listeners;
+
+    for (size_t i = 0; i < HANDLERS; ++i) {
+        listeners.emplace_back(flagged.listen([&handled](bool& done) {
+            if (done)
+                return;
+
+            done = true;
+            handled++;
+        }));
+        listeners.emplace_back(consumable.listen([&handled] {
+            handled++;
+            return true;
+        }));
+    }
+
+    const auto run = [&](const char* name, auto&& emit) {
+        const auto BEGIN = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < EMITS; ++i) {
+            emit();
+        }
+        const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+        std::printf("%-31s %10.2f ns/emit\n", name, (double)NS / EMITS);
+    };
+
+    run("100 handlers, handled flag", [&] {
+        bool done = false;
+        flagged.emit(done);
+    });
+    run("100 handlers, CConsumableSignalT", [&] { consumable.emit(); });
+
+    if (handled != 2 * EMITS)
+        std::printf("unexpected result %zu\n", handled);
+}
+
+// an object subscribing to a lot of signals, with a lambda and a listener to keep vs a method of its own
+static void benchMember() {
+    constexpr size_t SIGNALS = 32;
+    constexpr size_t OWNERS  = 1000;
+
+    struct SOwner {
+        size_t                           sum = 0;
+        std::vector<CHyprSignalListener> listeners;
+
+        void onValue(int v) {
+            sum += v;
+        }
+    };
+
+    std::vector<CSignalT<int>> signals(SIGNALS);
+
+    const auto                 run = [&](const char* name, auto&& subscribe) {
+        std::vector<CSharedPointer<SOwner>> owners;
+        for (size_t i = 0; i < OWNERS; ++i) {
+            owners.emplace_back(makeShared<SOwner>());
+        }
+
+        g_allocations    = 0;
+        auto       BEGIN = std::chrono::steady_clock::now();
+        for (auto& owner : owners) {
+            for (auto& signal : signals) {
+                subscribe(signal, owner);
+            }
+        }
+        const auto SUBSCRIBE_NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+        const auto ALLOCATIONS  = g_allocations;
+
+        BEGIN = std::chrono::steady_clock::now();
+        for (auto& signal : signals) {
+            signal.emit(1);
+        }
+        const auto EMIT_NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+        std::printf("%-31s %10.2f ns/listen %6.2f allocs/listen %8.2f ns/call\n", name, (double)SUBSCRIBE_NS / (SIGNALS * OWNERS), (double)ALLOCATIONS / (SIGNALS * OWNERS),
+                    (double)EMIT_NS / (SIGNALS * OWNERS));
+
+        if (owners[0]->sum != SIGNALS)
+            std::printf("unexpected result %zu\n", owners[0]->sum);
+    };
+
+    run("listen(lambda)", [](CSignalT<int>& signal, CSharedPointer<SOwner>& owner) {
+        owner->listeners.emplace_back(signal.listen([raw = owner.get()](int v) { raw->onValue(v); }));
+    });
+
+    // fresh signals, the owners of the previous run are gone
+    signals = std::vector<CSignalT<int>>(SIGNALS);
+    run("listen(owner, &method)", [](CSignalT<int>& signal, CSharedPointer<SOwner>& owner) { signal.listen(CWeakPointer<SOwner>(owner), &SOwner::onValue); });
+}
+
+// a worker thread emitting while the owner dispatches, timed on the worker
+static void benchCrossThread() {
+    constexpr size_t              EMITS = CALLS / 10;
+    size_t                        sum   = 0;
+
+    CCrossThreadSignalT<int>      signal;
+    auto                          listener = signal.listen([&sum](int v) { sum += v; });
+
+    std::atomic<int64_t>          producerNs = 0;
+    std::thread                   producer([&] {
+        const auto BEGIN = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < EMITS; ++i) {
+            signal.emitFromAnyThread(1);
+        }
+        producerNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+    });
+
+    // the owner's event loop
+    pollfd pfd = {.fd = signal.getFD().get(), .events = POLLIN, .revents = 0};
+    while (sum < EMITS) {
+        poll(&pfd, 1, -1);
+        signal.dispatchPending();
+    }
+    producer.join();
+
+    std::printf("%-31s %10.2f ns/emit\n", "emitFromAnyThread", (double)producerNs / EMITS);
+}
+
+int main() {
+    for (const size_t COUNT : {0, 1, 10, 1000}) {
+        benchEmit(COUNT, 0);
+    }
+
+    for (const size_t COUNT : {1, 10, 1000}) {
+        benchEmit(0, COUNT);
+    }
+
+    benchKeyed();
+    benchChurn();
+    benchDeferred();
+    benchMember();
+    benchConsumable();
+    benchCrossThread();
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <hyprutils/utils/Function.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+
+using namespace Hyprutils::Utils;
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+constexpr size_t ITERATIONS = 1000000;
+
+template <typename Fn>
+static void bench(const char* name, Fn&& fn) {
+    g_allocations = 0;
+
+    const auto BEGIN = std::chrono::steady_clock::now();
+    fn();
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - BEGIN).count();
+
+    std::printf("%-36s %8.2f ns/op %6.2f allocs/op\n", name, (double)NS / ITERATIONS, (double)g_allocations / ITERATIONS);
+}
+
+// a capture of N bytes, the size of a typical handler capturing a few pointers
+template <size_t N>
+static auto makeCallable() {
+    std::array<size_t, N / sizeof(size_t)> capture = {};
+    capture[0]                                     = 1;
+    return [capture](size_t x) { return x + capture[0]; };
+}
+
+template <template <typename> typename Fn, size_t N>
+static void benchCapture(const char* name) {
+    std::vector<Fn<size_t(size_t)>> fns;
+    fns.reserve(ITERATIONS);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s %zuB create+destroy", name, N);
+    bench(label, [&] {
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            fns.emplace_back(makeCallable<N>());
+        }
+        fns.clear();
+    });
+
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        fns.emplace_back(makeCallable<N>());
+    }
+
+    // every call goes to its own callable, like emitting to many listeners
+    size_t sum = 0;
+    std::snprintf(label, sizeof(label), "%s %zuB call", name, N);
+    bench(label, [&] {
+        for (auto& f : fns) {
+            sum = f(sum);
+        }
+    });
+
+    if (sum != ITERATIONS)
+        std::printf("unexpected result %zu\n", sum);
+}
+
+int main() {
+    benchCapture<std::function, 8>("std::function");
+    benchCapture<CFunction, 8>("CFunction");
+    benchCapture<std::function, 32>("std::function");
+    benchCapture<CFunction, 32>("CFunction");
+    benchCapture<std::function, 48>("std::function");
+    benchCapture<CFunction, 48>("CFunction");
+    benchCapture<std::function, 128>("std::function");
+    benchCapture<CFunction, 128>("CFunction");
+
+    return 0;
+}
@@ -4,9 +4,9 @@
 #include "../memory/WeakPtr.hpp"
 #include "../memory/SharedPtr.hpp"
 #include "../signal/Signal.hpp"
+#include "../utils/Function.hpp"
 #include "AnimationManager.hpp"
 
-#include <functional>
 #include <chrono>
 
 namespace Hyprutils {
@@ -15,7 +15,7 @@ namespace Hyprutils {
         /* A base class for animated variables. */
         class CBaseAnimatedVariable {
           public:
-            using CallbackFun = std::function<void(Memory::CWeakPointer<CBaseAnimatedVariable> thisptr)>;
+            using CallbackFun = Utils::CFunction<void(Memory::CWeakPointer<CBaseAnimatedVariable> thisptr)>;
 
             CBaseAnimatedVariable() {
                 ; // m_bDummy = true;
@@ -53,6 +53,7 @@ namespace Hyprutils {
 
             /* returns the spent (completion) % */
             float getPercent() const;
+            float getPercent(std::chrono::steady_clock::time_point now) const;
 
             /* returns the current curve value. */
             float getCurveValue() const;
@@ -234,5 +235,19 @@ namespace Hyprutils {
             VarType m_Goal{};
             VarType m_Begun{};
         };
+
+        template <typename VarType, class AnimationContext, typename Lerp>
+        void CAnimationManager::setTickHandler(int type, Lerp lerp) {
+            setTickHandler(type, [lerp = std::move(lerp)](std::span<const STickStep> steps) {
+                for (const auto& STEP : steps) {
+                    auto* const PAV = Memory::sc<CGenericAnimatedVariable<VarType, AnimationContext>*>(STEP.var);
+
+                    if (STEP.curve >= 1.f)
+                        PAV->value() = PAV->goal();
+                    else
+                        PAV->value() = lerp(PAV->begun(), PAV->goal(), STEP.curve);
+                }
+            });
+        }
     }
 }
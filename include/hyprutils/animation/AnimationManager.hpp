@@ -4,8 +4,11 @@
 #include "../math/Vector2D.hpp"
 #include "../memory/WeakPtr.hpp"
 #include "../signal/Signal.hpp"
+#include "../utils/Function.hpp"
 
+#include <chrono>
 #include <cstdint>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +29,41 @@ namespace Hyprutils {
             virtual void                                                                 scheduleTick() = 0;
             virtual void                                                                 onTicked()     = 0;
 
+            /* one active variable for a tick handler */
+            struct STickStep {
+                CBaseAnimatedVariable* var = nullptr;
+                /* the bezier value for this tick, 1 once the animation is over */
+                float curve = 1.f;
+            };
+
+            using TickHandler = Utils::CFunction<void(std::span<const STickStep> steps)>;
+
+            /* begun + (goal - begun) * curve */
+            struct SLinearLerp {
+                template <typename T>
+                T operator()(const T& begun, const T& goal, float curve) const {
+                    return T(begun + ((goal - begun) * curve));
+                }
+            };
+
+            /*
+                Sets the handler tick() steps the variables of a type with, replacing the previous one.
+                The handler gets all of them at once and only sets values, the callbacks run after it.
+                Variables of a type without a handler are left to the caller.
+            */
+            void setTickHandler(int type, TickHandler handler);
+
+            /* A handler for CGenericAnimatedVariable<VarType, AnimationContext>, setting values to lerp(begun, goal, curve). Needs AnimatedVariable.hpp. */
+            template <typename VarType, class AnimationContext, typename Lerp = SLinearLerp>
+            void setTickHandler(int type, Lerp lerp = {});
+
+            /*
+                Steps every active variable that has a handler for its type, reading the time only once.
+                All values are set first, then the update callbacks run, then the animations that are over are ended.
+                Calls tickDone() at the end.
+            */
+            void tick(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
             void                                                                         addBezierWithName(std::string, const Math::Vector2D&, const Math::Vector2D&);
             void                                                                         removeAllBeziers();
 
@@ -48,6 +86,22 @@ namespace Hyprutils {
 
             bool                                                                  m_bTickScheduled = false;
 
+            struct STypeTicker {
+                int                    type = -1;
+                TickHandler            handler;
+                std::vector<STickStep> steps;
+            };
+
+            struct STicked {
+                Memory::CWeakPointer<CBaseAnimatedVariable> var;
+                std::chrono::steady_clock::time_point       begin;
+                bool                                        over = false;
+            };
+
+            /* storage is kept between ticks */
+            std::vector<STypeTicker> m_vTickers;
+            std::vector<STicked>     m_vTicked;
+
             struct SAnimVarListeners {
                 Signal::CHyprSignalListener connect;
                 Signal::CHyprSignalListener disconnect;
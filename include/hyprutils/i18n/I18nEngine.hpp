@@ -1,17 +1,17 @@
 #pragma once
 
 #include "../memory/UniquePtr.hpp"
+#include "../utils/Function.hpp"
 
 #include <cstdint>
 #include <string>
 #include <unordered_map>
-#include <functional>
 
 namespace Hyprutils::I18n {
     struct SI18nEngineImpl;
 
-    typedef std::unordered_map<std::string, std::string>         translationVarMap;
-    typedef std::function<std::string(const translationVarMap&)> translationFn;
+    typedef std::unordered_map<std::string, std::string>            translationVarMap;
+    typedef Utils::CFunction<std::string(const translationVarMap&)> translationFn;
 
     class CI18nLocale {
       public:
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "SharedPtr.hpp"
+#include "UniquePtr.hpp"
+
+/*
+    allocateShared / allocateUnique work like makeShared / makeUnique,
+    but take the single block for the control block and the object from a std::pmr::memory_resource.
+    The resource has to outlive every pointer to the object, weak ones included,
+    as the block goes back to it once the last weak ref is gone.
+
+    The block is laid out as [SAllocatedHeader][impl_base][T].
+*/
+
+namespace Hyprutils::Memory {
+    namespace Impl_ {
+        /* remembers where the block came from */
+        struct SAllocatedHeader {
+            std::pmr::memory_resource* resource = nullptr;
+            size_t                     size     = 0;
+        };
+
+        constexpr size_t ALLOCATED_ALIGNMENT = alignof(std::max_align_t);
+
+        // keeps the data as aligned as the block itself
+        static_assert(sizeof(SAllocatedHeader) % ALLOCATED_ALIGNMENT == 0 && sizeof(impl_base) % ALLOCATED_ALIGNMENT == 0);
+
+        template <typename T, typename... Args>
+        impl_base* makeAllocated(std::pmr::memory_resource* resource, bool lockable, Args&&... args) {
+            static_assert(fusable<T>(), "allocateShared / allocateUnique don't support overaligned types");
+
+            const size_t SIZE   = sizeof(SAllocatedHeader) + sizeof(impl_base) + sizeof(T);
+            auto         block  = sc<unsigned char*>(resource->allocate(SIZE, ALLOCATED_ALIGNMENT));
+            void*        header = block;
+            void*        impl   = block + sizeof(SAllocatedHeader);
+            void*        data   = block + sizeof(SAllocatedHeader) + sizeof(impl_base);
+
+            ::new (header) SAllocatedHeader{.resource = resource, .size = SIZE};
+            auto result = ::new (impl) impl_base([](void* p) { std::destroy_at(sc<T*>(p)); },
+                                                 impl_base::FLAG_FUSED | impl_base::FLAG_ALLOCATED | (lockable ? 0 : impl_base::FLAG_UNLOCKABLE));
+
+            try {
+                constructFusedData<T>(data, std::forward<Args>(args)...);
+            } catch (...) {
+                // see makeFused
+                if (result->wref() == 0)
+                    resource->deallocate(block, SIZE, ALLOCATED_ALIGNMENT);
+                throw;
+            }
+
+            return tracked<T>(result);
+        }
+    }
+
+    /* allocates the object and its control block in one go, from the given resource */
+    template <typename U, typename... Args>
+    [[nodiscard]] inline CSharedPointer<U> allocateShared(std::pmr::memory_resource* resource, Args&&... args) {
+        return CSharedPointer<U>(Impl_::makeAllocated<U>(resource, true, std::forward<Args>(args)...));
+    }
+
+    /* allocates the object and its control block in one go, from the given resource */
+    template <typename U, typename... Args>
+    [[nodiscard]] inline CUniquePointer<U> allocateUnique(std::pmr::memory_resource* resource, Args&&... args) {
+        return CUniquePointer<U>(Impl_::makeAllocated<U>(resource, false, std::forward<Args>(args)...));
+    }
+}
@@ -3,10 +3,12 @@
 #include "./ImplBase.hpp"
 #include "./SharedPtr.hpp"
 #include "./WeakPtr.hpp"
-#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <utility>
 
 /*
-    This header provides a thread-safe wrapper for Hyprutils shared pointer implementations.
+    This header provides thread-safe variants of the Hyprutils shared pointer implementations.
     Like with STL shared pointers, that does not mean that individual SP/WP objects can be shared across threads without synchronization.
     It only means that the refcounting of the data is thread-safe.
 
@@ -19,32 +21,66 @@
       However, if we create a copy of this CAtomicWeakPointer member for each thread that accesses it,
       then the references to the object will be counted in a thread-safe manner and it will be safe to lock a WP and to access the data in case of an SP.
       In such an example, the inner data would need its own synchronization mechanism if it isn't constant itself.
+
+    The refcounts live in a regular Impl_::impl_base and are modified through atomic ops only, there is no lock.
+    Contrary to the non-atomic pointers, all strong refs together hold one weak ref.
+    That way, whoever drops the weak count to zero can free the block, even if the data is being destroyed on another thread.
+    Do not mix atomic and non-atomic pointers on the same object.
 */
 
 namespace Hyprutils::Memory {
     namespace Atomic_ {
-        class impl : public Impl_::impl_base {
-            std::recursive_mutex m_mutex;
+        inline void increment(Impl_::impl_base* impl) noexcept {
+            // see impl_base::inc()
+            if ((impl->atomicRef().fetch_add(1, std::memory_order_relaxed) & Impl_::impl_base::REF_MASK) == Impl_::impl_base::REF_MASK) [[unlikely]]
+                std::abort();
+        }
 
-          public:
-            impl(void* data, DeleteFn deleter) noexcept : Impl_::impl_base(data, deleter) {
-                ;
-            }
+        inline void incrementWeak(Impl_::impl_base* impl) noexcept {
+            impl->atomicWref().fetch_add(1, std::memory_order_relaxed);
+        }
 
-            std::lock_guard<std::recursive_mutex> lockGuard() {
-                return std::lock_guard<std::recursive_mutex>(m_mutex);
-            }
+        /* frees the block if this was the last weak ref */
+        inline void decrementWeak(Impl_::impl_base* impl) noexcept {
+            if (impl->atomicWref().fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Impl_::impl_base::deallocate(impl);
+        }
 
-            // Needed when unlock order or mutex lifetime matters.
-            std::recursive_mutex& getMutex() {
-                return m_mutex;
-            }
-        };
+        /* destroys the data if this was the last strong ref, then drops the weak ref held by the strong ones */
+        inline void decrement(Impl_::impl_base* impl) noexcept {
+            if ((impl->atomicRef().fetch_sub(1, std::memory_order_acq_rel) & Impl_::impl_base::REF_MASK) != 1)
+                return;
+
+            impl->destroy();
+            decrementWeak(impl);
+        }
+
+        /* takes a strong ref, unless the strong count already hit zero */
+        inline bool tryIncrement(Impl_::impl_base* impl) noexcept {
+            auto ref = impl->atomicRef().load(std::memory_order_relaxed);
+            do {
+                if ((ref & Impl_::impl_base::REF_MASK) == 0)
+                    return false;
+                if ((ref & Impl_::impl_base::REF_MASK) == Impl_::impl_base::REF_MASK) [[unlikely]]
+                    std::abort();
+            } while (!impl->atomicRef().compare_exchange_weak(ref, ref + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+            return true;
+        }
+
+        /* sets up a fresh block, held by one strong ref */
+        inline Impl_::impl_base* adoptNew(Impl_::impl_base* impl) noexcept {
+            impl->inc();
+            impl->incWeak();
+            return impl;
+        }
     }
 
-    // Forward declaration for friend
+    // Forward declarations for friend
     template <typename T>
     class CAtomicWeakPointer;
+    template <typename T>
+    class CAtomicSharedSlot;
 
     template <typename T>
     class CAtomicSharedPointer {
@@ -54,38 +90,34 @@ namespace Hyprutils::Memory {
         using validHierarchy = std::enable_if_t<std::is_assignable_v<CAtomicSharedPointer<T>&, X>, CAtomicSharedPointer&>;
 
       public:
-        explicit CAtomicSharedPointer(T* object) noexcept : m_ptr(new Atomic_::impl(sc<void*>(object), _delete)) {
+        explicit CAtomicSharedPointer(T* object) noexcept : impl_(Atomic_::adoptNew(Impl_::tracked<T>(new Impl_::impl_separate(sc<void*>(object), _delete)))) {
             ;
         }
 
-        CAtomicSharedPointer(Impl_::impl_base* impl) noexcept : m_ptr(impl) {
-            ;
+        /* takes a new strong ref on an atomic impl */
+        CAtomicSharedPointer(Impl_::impl_base* impl) noexcept : impl_(impl) {
+            if (impl_)
+                Atomic_::increment(impl_);
         }
 
-        CAtomicSharedPointer(const CAtomicSharedPointer<T>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicSharedPointer(const CAtomicSharedPointer<T>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                Atomic_::increment(impl_);
         }
 
         template <typename U, typename = isConstructible<U>>
-        CAtomicSharedPointer(const CAtomicSharedPointer<U>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicSharedPointer(const CAtomicSharedPointer<U>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                Atomic_::increment(impl_);
         }
 
         template <typename U, typename = isConstructible<U>>
         CAtomicSharedPointer(CAtomicSharedPointer<U>&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+            std::swap(impl_, ref.impl_);
         }
 
         CAtomicSharedPointer(CAtomicSharedPointer&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+            std::swap(impl_, ref.impl_);
         }
 
         CAtomicSharedPointer() noexcept = default;
@@ -100,13 +132,8 @@ namespace Hyprutils::Memory {
 
         template <typename U>
         validHierarchy<const CAtomicSharedPointer<U>&> operator=(const CAtomicSharedPointer<U>& rhs) {
-            reset();
-
-            if (!rhs.m_ptr.impl_)
-                return *this;
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
+            CAtomicSharedPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
             return *this;
         }
 
@@ -114,19 +141,14 @@ namespace Hyprutils::Memory {
             if (this == &rhs)
                 return *this;
 
-            reset();
-
-            if (!rhs.m_ptr.impl_)
-                return *this;
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
+            CAtomicSharedPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
             return *this;
         }
 
         template <typename U>
         validHierarchy<const CAtomicSharedPointer<U>&> operator=(CAtomicSharedPointer<U>&& rhs) noexcept {
-            std::swap(m_ptr, rhs.m_ptr);
+            std::swap(impl_, rhs.impl_);
             return *this;
         }
 
@@ -134,89 +156,43 @@ namespace Hyprutils::Memory {
             if (this == &rhs)
                 return *this;
 
-            std::swap(m_ptr, rhs.m_ptr);
+            std::swap(impl_, rhs.impl_);
             return *this;
         }
 
         void reset() {
-            if (!m_ptr.impl_)
-                return;
-
-            // last ref and last wref?
-            // -> must unlock BEFORE reset
-            // not last ref?
-            // -> must unlock AFTER reset
-            auto& mutex = sc<Atomic_::impl*>(m_ptr.impl_)->getMutex();
-            mutex.lock();
-
-            if (m_ptr.impl_->ref() > 1) {
-                m_ptr.reset();
-                mutex.unlock();
-                return;
-            }
-
-            if (m_ptr.impl_->wref() == 0) {
-                mutex.unlock(); // Don't hold the mutex when destroying it
-
-                m_ptr.impl_->destroy();
-                delete sc<Atomic_::impl*>(m_ptr.impl_);
-                m_ptr.impl_ = nullptr;
-
-                // mutex invalid
+            if (!impl_)
                 return;
-            } else {
-                // When the control block gets destroyed, the mutex is destroyed with it.
-                // Thus we must avoid attempting an unlock after impl_ has been destroyed.
-                // Without the workaround is no safe way of checking whether it has been destroyed or not.
-                //
-                // To avoid this altogether, keep a weak pointer here.
-                // This guarantees that impl_ is still valid after the reset.
-                CWeakPointer<T> guard = m_ptr;
-                m_ptr.reset(); // destroys the data
-
-                // Now we can safely check if guard is the last wref.
-                if (guard.impl_->wref() == 1) {
-                    mutex.unlock();
-
-                    // destroy impl_ (includes the mutex)
-                    delete sc<Atomic_::impl*>(guard.impl_);
-                    guard.impl_ = nullptr;
-
-                    // mutex invalid
-                    return;
-                }
 
-                guard.reset();
-                mutex.unlock();
-            }
+            Atomic_::decrement(std::exchange(impl_, nullptr));
         }
 
         T& operator*() const {
-            return *m_ptr;
+            return *get();
         }
 
         T* operator->() const {
-            return m_ptr.get();
+            return get();
         }
 
         T* get() const {
-            return m_ptr.get();
+            return impl_ ? sc<T*>(impl_->getData()) : nullptr;
         }
 
         operator bool() const {
-            return m_ptr;
+            return impl_;
         }
 
         bool operator==(const CAtomicSharedPointer& rhs) const {
-            return m_ptr == rhs.m_ptr;
+            return impl_ == rhs.impl_;
         }
 
         bool operator()(const CAtomicSharedPointer& lhs, const CAtomicSharedPointer& rhs) const {
-            return lhs.m_ptr == rhs.m_ptr;
+            return lhs.impl_ == rhs.impl_;
         }
 
         unsigned int strongRef() const {
-            return m_ptr.impl_ ? m_ptr.impl_->ref() : 0;
+            return impl_ ? impl_->atomicRef().load(std::memory_order_relaxed) & Impl_::impl_base::REF_MASK : 0;
         }
 
       private:
@@ -224,16 +200,23 @@ namespace Hyprutils::Memory {
             std::default_delete<T>{}(sc<T*>(p));
         }
 
-        std::lock_guard<std::recursive_mutex> implLockGuard() const {
-            return sc<Atomic_::impl*>(m_ptr.impl_)->lockGuard();
+        struct SAdopt {};
+
+        /* takes over a strong ref that was already counted */
+        CAtomicSharedPointer(Impl_::impl_base* impl, SAdopt) noexcept : impl_(impl) {
+            ;
         }
 
-        CSharedPointer<T> m_ptr;
+        Impl_::impl_base* impl_ = nullptr;
 
         template <typename U>
         friend class CAtomicWeakPointer;
         template <typename U>
         friend class CAtomicSharedPointer;
+        template <typename U>
+        friend class CAtomicSharedSlot;
+        template <typename U, typename... Args>
+        friend CAtomicSharedPointer<U> makeAtomicShared(Args&&... args);
     };
 
     template <typename T>
@@ -245,38 +228,29 @@ namespace Hyprutils::Memory {
         using validHierarchy = std::enable_if_t<std::is_assignable_v<CAtomicWeakPointer<T>&, X>, CAtomicWeakPointer&>;
 
       public:
-        CAtomicWeakPointer(const CAtomicWeakPointer<T>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicWeakPointer(const CAtomicWeakPointer<T>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                Atomic_::incrementWeak(impl_);
         }
 
         template <typename U, typename = isConstructible<U>>
-        CAtomicWeakPointer(const CAtomicWeakPointer<U>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicWeakPointer(const CAtomicWeakPointer<U>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                Atomic_::incrementWeak(impl_);
         }
 
         template <typename U, typename = isConstructible<U>>
         CAtomicWeakPointer(CAtomicWeakPointer<U>&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+            std::swap(impl_, ref.impl_);
         }
 
         CAtomicWeakPointer(CAtomicWeakPointer&& ref) noexcept {
-            std::swap(m_ptr, ref.m_ptr);
+            std::swap(impl_, ref.impl_);
         }
 
-        CAtomicWeakPointer(const CAtomicSharedPointer<T>& ref) {
-            if (!ref.m_ptr.impl_)
-                return;
-
-            auto lg = ref.implLockGuard();
-            m_ptr   = ref.m_ptr;
+        CAtomicWeakPointer(const CAtomicSharedPointer<T>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                Atomic_::incrementWeak(impl_);
         }
 
         CAtomicWeakPointer() noexcept = default;
@@ -291,10 +265,8 @@ namespace Hyprutils::Memory {
 
         template <typename U>
         validHierarchy<const CAtomicWeakPointer<U>&> operator=(const CAtomicWeakPointer<U>& rhs) {
-            reset();
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
+            CAtomicWeakPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
             return *this;
         }
 
@@ -302,16 +274,14 @@ namespace Hyprutils::Memory {
             if (this == &rhs)
                 return *this;
 
-            reset();
-
-            auto lg = rhs.implLockGuard();
-            m_ptr   = rhs.m_ptr;
+            CAtomicWeakPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
             return *this;
         }
 
         template <typename U>
         validHierarchy<const CAtomicWeakPointer<U>&> operator=(CAtomicWeakPointer<U>&& rhs) noexcept {
-            std::swap(m_ptr, rhs.m_ptr);
+            std::swap(impl_, rhs.impl_);
             return *this;
         }
 
@@ -319,87 +289,66 @@ namespace Hyprutils::Memory {
             if (this == &rhs)
                 return *this;
 
-            std::swap(m_ptr, rhs.m_ptr);
+            std::swap(impl_, rhs.impl_);
             return *this;
         }
 
         void reset() {
-            if (!m_ptr.impl_)
+            if (!impl_)
                 return;
 
-            // last ref and last wref?
-            // -> must unlock BEFORE reset
-            // not last ref?
-            // -> must unlock AFTER reset
-            auto& mutex = sc<Atomic_::impl*>(m_ptr.impl_)->getMutex();
-            mutex.lock();
-            if (m_ptr.impl_->ref() == 0 && m_ptr.impl_->wref() == 1) {
-                mutex.unlock();
-
-                delete sc<Atomic_::impl*>(m_ptr.impl_);
-                m_ptr.impl_ = nullptr;
-                // mutex invalid
-                return;
-            }
-
-            m_ptr.reset();
-            mutex.unlock();
+            Atomic_::decrementWeak(std::exchange(impl_, nullptr));
         }
 
+        /* only safe to use while a strong ref is held, prefer lock() */
         T& operator*() const {
-            return *m_ptr;
+            return *get();
         }
 
+        /* only safe to use while a strong ref is held, prefer lock() */
         T* operator->() const {
-            return m_ptr.get();
+            return get();
         }
 
+        /* only safe to use while a strong ref is held, prefer lock() */
         T* get() const {
-            return m_ptr.get();
+            return impl_ ? sc<T*>(impl_->getData()) : nullptr;
         }
 
         operator bool() const {
-            return m_ptr;
+            return valid();
         }
 
         bool operator==(const CAtomicWeakPointer& rhs) const {
-            return m_ptr == rhs.m_ptr;
+            return impl_ == rhs.impl_;
         }
 
         bool operator==(const CAtomicSharedPointer<T>& rhs) const {
-            return m_ptr == rhs.m_ptr;
+            return impl_ == rhs.impl_;
         }
 
         bool operator()(const CAtomicWeakPointer& lhs, const CAtomicWeakPointer& rhs) const {
-            return lhs.m_ptr == rhs.m_ptr;
+            return lhs.impl_ == rhs.impl_;
         }
 
-        bool expired() {
-            return m_ptr.expired();
+        bool expired() const {
+            return !valid();
         }
 
-        bool valid() {
-            return m_ptr.valid();
+        /* a strong ref existed at the time of the call. It may be gone by the time this returns. */
+        bool valid() const {
+            return impl_ && (impl_->atomicRef().load(std::memory_order_acquire) & Impl_::impl_base::REF_MASK) != 0;
         }
 
         CAtomicSharedPointer<T> lock() const {
-            if (!m_ptr.impl_)
-                return {};
-
-            auto lg = implLockGuard();
-
-            if (!m_ptr.impl_->dataNonNull() || m_ptr.impl_->destroying() || !m_ptr.impl_->lockable())
+            if (!impl_ || !Atomic_::tryIncrement(impl_))
                 return {};
 
-            return CAtomicSharedPointer<T>(m_ptr.impl_);
+            return CAtomicSharedPointer<T>(impl_, typename CAtomicSharedPointer<T>::SAdopt{});
         }
 
       private:
-        std::lock_guard<std::recursive_mutex> implLockGuard() const {
-            return sc<Atomic_::impl*>(m_ptr.impl_)->lockGuard();
-        }
-
-        CWeakPointer<T> m_ptr;
+        Impl_::impl_base* impl_ = nullptr;
 
         template <typename U>
         friend class CAtomicWeakPointer;
@@ -407,8 +356,135 @@ namespace Hyprutils::Memory {
         friend class CAtomicSharedPointer;
     };
 
+    /* allocates the object and its control block in one go */
     template <typename U, typename... Args>
     [[nodiscard]] inline CAtomicSharedPointer<U> makeAtomicShared(Args&&... args) {
-        return CAtomicSharedPointer<U>(new U(std::forward<Args>(args)...));
+        return CAtomicSharedPointer<U>(Atomic_::adoptNew(Impl_::makeFused<U>(true, std::forward<Args>(args)...)), typename CAtomicSharedPointer<U>::SAdopt{});
     }
+
+    /*
+        A CAtomicSharedPointer that can be loaded and replaced from multiple threads, like std::atomic<std::shared_ptr>.
+        Meant for publishing snapshots: a writer stores a new version, readers load whatever is current.
+
+        Readers never lock and never wait for a writer. A load borrows the current pointer by bumping a counter
+        packed into the upper 16 bits of the slot word, takes a strong ref and then gives the borrow back.
+        When a writer swaps the pointer out, it credits the old object with the outstanding borrows before dropping
+        the slot's own ref, and readers that find their borrow gone release that credit instead.
+        This relies on userspace pointers fitting in 48 bits, which holds for x86_64 and aarch64.
+    */
+    template <typename T>
+    class CAtomicSharedSlot {
+      public:
+        CAtomicSharedSlot() noexcept = default;
+
+        CAtomicSharedSlot(CAtomicSharedPointer<T> desired) noexcept : m_word(pack(std::exchange(desired.impl_, nullptr))) {
+            ;
+        }
+
+        /* must not race with any other access */
+        ~CAtomicSharedSlot() {
+            if (auto impl = unpack(m_word.load(std::memory_order_acquire)); impl)
+                Atomic_::decrement(impl);
+        }
+
+        CAtomicSharedSlot(const CAtomicSharedSlot&)            = delete;
+        CAtomicSharedSlot(CAtomicSharedSlot&&)                 = delete;
+        CAtomicSharedSlot& operator=(const CAtomicSharedSlot&) = delete;
+        CAtomicSharedSlot& operator=(CAtomicSharedSlot&&)      = delete;
+
+        CAtomicSharedPointer<T> load() const noexcept {
+            const auto WORD = m_word.fetch_add(BORROW, std::memory_order_acquire) + BORROW;
+            const auto IMPL = unpack(WORD);
+
+            if (IMPL)
+                Atomic_::increment(IMPL);
+
+            // give the borrow back. If the pointer was swapped out in the meantime, the writer
+            // has turned our borrow into a strong ref on IMPL, which we hold on top of our own.
+            auto current = WORD;
+            while (true) {
+                if (unpack(current) != IMPL || (current & ~PTRMASK) == 0) {
+                    if (IMPL)
+                        Atomic_::decrement(IMPL);
+                    break;
+                }
+
+                if (m_word.compare_exchange_weak(current, current - BORROW, std::memory_order_relaxed, std::memory_order_relaxed))
+                    break;
+            }
+
+            return CAtomicSharedPointer<T>(IMPL, typename CAtomicSharedPointer<T>::SAdopt{});
+        }
+
+        void store(CAtomicSharedPointer<T> desired) noexcept {
+            release(m_word.exchange(pack(std::exchange(desired.impl_, nullptr)), std::memory_order_acq_rel));
+        }
+
+        CAtomicSharedPointer<T> exchange(CAtomicSharedPointer<T> desired) noexcept {
+            const auto OLD  = m_word.exchange(pack(std::exchange(desired.impl_, nullptr)), std::memory_order_acq_rel);
+            const auto IMPL = unpack(OLD);
+
+            // keep the slot's ref, it's now the returned pointer's
+            if (IMPL)
+                creditBorrows(OLD);
+
+            return CAtomicSharedPointer<T>(IMPL, typename CAtomicSharedPointer<T>::SAdopt{});
+        }
+
+        /* stores desired if the slot still holds expected. On failure, expected is set to the current value. */
+        bool compareExchange(CAtomicSharedPointer<T>& expected, CAtomicSharedPointer<T> desired) noexcept {
+            auto current = m_word.load(std::memory_order_relaxed);
+            while (unpack(current) == expected.impl_) {
+                if (!m_word.compare_exchange_weak(current, pack(desired.impl_), std::memory_order_acq_rel, std::memory_order_relaxed))
+                    continue;
+
+                desired.impl_ = nullptr;
+                release(current);
+                return true;
+            }
+
+            expected = load();
+            return false;
+        }
+
+        operator bool() const noexcept {
+            return unpack(m_word.load(std::memory_order_acquire));
+        }
+
+      private:
+        static constexpr uint64_t PTRBITS = 48;
+        static constexpr uint64_t PTRMASK = (1ULL << PTRBITS) - 1;
+        static constexpr uint64_t BORROW  = 1ULL << PTRBITS;
+
+        static_assert(sizeof(void*) == sizeof(uint64_t), "CAtomicSharedSlot packs pointers into 64 bits");
+
+        static uint64_t pack(Impl_::impl_base* impl) noexcept {
+            return rc<uintptr_t>(impl);
+        }
+
+        static Impl_::impl_base* unpack(uint64_t word) noexcept {
+            return rc<Impl_::impl_base*>(sc<uintptr_t>(word & PTRMASK));
+        }
+
+        /* turns the outstanding borrows of a swapped out word into strong refs */
+        static void creditBorrows(uint64_t word) noexcept {
+            if (const auto BORROWS = word >> PTRBITS; BORROWS) {
+                const auto REF = unpack(word)->atomicRef().fetch_add(BORROWS, std::memory_order_relaxed) & Impl_::impl_base::REF_MASK;
+                if (REF + BORROWS > Impl_::impl_base::REF_MASK) [[unlikely]]
+                    std::abort();
+            }
+        }
+
+        /* drops a swapped out word, including the slot's own ref */
+        static void release(uint64_t word) noexcept {
+            const auto IMPL = unpack(word);
+            if (!IMPL)
+                return;
+
+            creditBorrows(word);
+            Atomic_::decrement(IMPL);
+        }
+
+        mutable std::atomic<uint64_t> m_word = 0;
+    };
 }
@@ -0,0 +1,438 @@
+#pragma once
+
+#include "./Casts.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+    Thread-safe shared pointers for objects that are mostly refcounted by the thread that created them.
+
+    The control block has two strong counts: a plain one that only the owner thread touches,
+    and an atomic one for every other thread. Copies and resets on the owner thread are
+    therefore as cheap as with CSharedPointer, while other threads pay for atomics like with
+    CAtomicSharedPointer.
+
+    Refs counted by the owner may be dropped on another thread, which makes the shared count go negative.
+    The first time that happens, the block is queued on its owner, since only the owner can tell whether
+    its own count is used up. The owner merges the counts once its own count hits zero, or when it
+    processes its queue, see mergeBiasedRefs(). From then on, every thread uses the shared count.
+    If the owner thread exits, its queue is processed on exit and later blocks are merged by whoever queues them.
+
+    Until a queued block is merged, a weak pointer may still lock it, even if the last strong ref is gone.
+
+    The same rules as for CAtomicSharedPointer apply: a single SP/WP object must not be
+    accessed from multiple threads without synchronization, each thread should have its own copies.
+*/
+
+namespace Hyprutils::Memory {
+    namespace Biased_ {
+        class impl;
+        struct SOwner;
+
+        /* the owner state of the calling thread, if it created any biased pointer */
+        inline thread_local SOwner* tlsOwner = nullptr;
+
+        /* the owner state of the calling thread, created on first use. Returns a new ref to it. */
+        SOwner* acquireOwner();
+        void    releaseOwner(SOwner* owner);
+        /* hands a block to its owner to merge. Merges right away if the owner thread is gone. */
+        void enqueue(SOwner* owner, impl* block);
+
+        class impl {
+          public:
+            using DeleteFn = void (*)(void*);
+
+            impl(void* data, DeleteFn deleter) noexcept : _data(data), _deleter(deleter), _owner(acquireOwner()) {
+                ;
+            }
+
+            ~impl() {
+                releaseOwner(_owner);
+            }
+
+            void inc() noexcept {
+                if (ownedByThisThread()) {
+                    _biased++;
+                    return;
+                }
+
+                _shared.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /* destroys the data if this was the last strong ref, may free the block */
+            void dec() noexcept {
+                if (ownedByThisThread()) {
+                    if (--_biased == 0)
+                        merge();
+                    return;
+                }
+
+                auto state = _shared.load(std::memory_order_relaxed);
+                while (true) {
+                    auto       next  = state - 1;
+                    const bool QUEUE = !(state & (MERGED | QUEUED)) && count(next) < 0;
+                    if (QUEUE)
+                        next |= QUEUED;
+
+                    if (!_shared.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+                        continue;
+
+                    if ((state & MERGED) && count(next) == 0)
+                        destroy();
+                    else if (QUEUE) {
+                        incWeak(); // held by the queue
+                        enqueue(_owner, this);
+                    }
+
+                    return;
+                }
+            }
+
+            /* takes a strong ref, unless the object is already dead */
+            bool tryInc() noexcept {
+                if (ownedByThisThread()) {
+                    _biased++;
+                    return true;
+                }
+
+                auto state = _shared.load(std::memory_order_relaxed);
+                do {
+                    if ((state & MERGED) && count(state) <= 0)
+                        return false;
+                } while (!_shared.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+                return true;
+            }
+
+            void incWeak() noexcept {
+                _weak.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /* frees the block if this was the last weak ref */
+            void decWeak() noexcept {
+                if (_weak.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    delete this;
+            }
+
+            /* an owner or shared ref existed at the time of the call */
+            bool alive() noexcept {
+                if (ownedByThisThread())
+                    return true;
+
+                const auto STATE = _shared.load(std::memory_order_acquire);
+                return !(STATE & MERGED) || count(STATE) > 0;
+            }
+
+            void* getData() noexcept {
+                return _data;
+            }
+
+            /* folds the owner count into the shared one. Only called by the owner,
+               or by whoever queued the block after the owner thread exited. */
+            void mergeQueued() noexcept {
+                if (_merged)
+                    return;
+
+                const auto BIASED = std::exchange(_biased, 0);
+                _merged           = true;
+
+                const auto OLD = _shared.fetch_add(BIASED + MERGED, std::memory_order_acq_rel);
+                if (count(OLD) + sc<int64_t>(BIASED) == 0)
+                    destroy();
+            }
+
+          private:
+            static constexpr uint64_t MERGED = 1ULL << 63;
+            static constexpr uint64_t QUEUED = 1ULL << 62;
+            // keeps the shared count from borrowing into the flags when it goes negative
+            static constexpr uint64_t OFFSET = 1ULL << 61;
+
+            static int64_t count(uint64_t state) noexcept {
+                return sc<int64_t>(state & ~(MERGED | QUEUED)) - sc<int64_t>(OFFSET);
+            }
+
+            /* if the caller is the owner thread and the owner count is still in use.
+               _merged is owner-only, so it must be checked last. */
+            bool ownedByThisThread() noexcept {
+                return _owner == tlsOwner && !_merged;
+            }
+
+            /* the owner's count hit zero, hand over to the shared count */
+            void merge() noexcept {
+                _merged        = true;
+                const auto OLD = _shared.fetch_or(MERGED, std::memory_order_acq_rel);
+                if (count(OLD) == 0)
+                    destroy();
+            }
+
+            void destroy() noexcept {
+                _deleter(_data);
+                _data = nullptr;
+                decWeak();
+            }
+
+            void*                     _data    = nullptr;
+            DeleteFn                  _deleter = nullptr;
+
+            SOwner*                   _owner = nullptr;
+            /* owner-only, non-atomic */
+            unsigned int              _biased = 1;
+            bool                      _merged = false;
+
+            /* refs from other threads, with the flags and OFFSET applied */
+            std::atomic<uint64_t>     _shared = OFFSET;
+            /* weak refs, plus one held by all strong refs together */
+            std::atomic<unsigned int> _weak = 1;
+        };
+    }
+
+    /* merges the blocks other threads queued on the calling thread. Call this from owner threads at safe points, e.g. once per event loop iteration. */
+    void mergeBiasedRefs();
+
+    template <typename T>
+    class CBiasedWeakPointer;
+
+    template <typename T>
+    class CBiasedSharedPointer {
+        template <typename X>
+        using isConstructible = std::enable_if_t<std::is_constructible_v<T&, X&>>;
+        template <typename X>
+        using validHierarchy = std::enable_if_t<std::is_assignable_v<CBiasedSharedPointer<T>&, X>, CBiasedSharedPointer&>;
+
+      public:
+        /* the calling thread becomes the owner */
+        explicit CBiasedSharedPointer(T* object) noexcept : impl_(new Biased_::impl(sc<void*>(object), _delete)) {
+            ;
+        }
+
+        CBiasedSharedPointer(const CBiasedSharedPointer& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                impl_->inc();
+        }
+
+        template <typename U, typename = isConstructible<U>>
+        CBiasedSharedPointer(const CBiasedSharedPointer<U>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                impl_->inc();
+        }
+
+        template <typename U, typename = isConstructible<U>>
+        CBiasedSharedPointer(CBiasedSharedPointer<U>&& ref) noexcept {
+            std::swap(impl_, ref.impl_);
+        }
+
+        CBiasedSharedPointer(CBiasedSharedPointer&& ref) noexcept {
+            std::swap(impl_, ref.impl_);
+        }
+
+        CBiasedSharedPointer() noexcept = default;
+
+        CBiasedSharedPointer(std::nullptr_t) noexcept {
+            ; // empty
+        }
+
+        ~CBiasedSharedPointer() {
+            reset();
+        }
+
+        template <typename U>
+        validHierarchy<const CBiasedSharedPointer<U>&> operator=(const CBiasedSharedPointer<U>& rhs) {
+            CBiasedSharedPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
+            return *this;
+        }
+
+        CBiasedSharedPointer& operator=(const CBiasedSharedPointer& rhs) {
+            if (this == &rhs)
+                return *this;
+
+            CBiasedSharedPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
+            return *this;
+        }
+
+        template <typename U>
+        validHierarchy<const CBiasedSharedPointer<U>&> operator=(CBiasedSharedPointer<U>&& rhs) noexcept {
+            std::swap(impl_, rhs.impl_);
+            return *this;
+        }
+
+        CBiasedSharedPointer& operator=(CBiasedSharedPointer&& rhs) noexcept {
+            if (this == &rhs)
+                return *this;
+
+            std::swap(impl_, rhs.impl_);
+            return *this;
+        }
+
+        void reset() {
+            if (!impl_)
+                return;
+
+            std::exchange(impl_, nullptr)->dec();
+        }
+
+        T& operator*() const {
+            return *get();
+        }
+
+        T* operator->() const {
+            return get();
+        }
+
+        T* get() const {
+            return impl_ ? sc<T*>(impl_->getData()) : nullptr;
+        }
+
+        operator bool() const {
+            return impl_;
+        }
+
+        bool operator==(const CBiasedSharedPointer& rhs) const {
+            return impl_ == rhs.impl_;
+        }
+
+      private:
+        static void _delete(void* p) {
+            std::default_delete<T>{}(sc<T*>(p));
+        }
+
+        struct SAdopt {};
+
+        /* takes over a strong ref that was already counted */
+        CBiasedSharedPointer(Biased_::impl* impl, SAdopt) noexcept : impl_(impl) {
+            ;
+        }
+
+        Biased_::impl* impl_ = nullptr;
+
+        template <typename U>
+        friend class CBiasedWeakPointer;
+        template <typename U>
+        friend class CBiasedSharedPointer;
+    };
+
+    template <typename T>
+    class CBiasedWeakPointer {
+        template <typename X>
+        using isConstructible = std::enable_if_t<std::is_constructible_v<T&, X&>>;
+        template <typename X>
+        using validHierarchy = std::enable_if_t<std::is_assignable_v<CBiasedWeakPointer<T>&, X>, CBiasedWeakPointer&>;
+
+      public:
+        CBiasedWeakPointer(const CBiasedWeakPointer& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                impl_->incWeak();
+        }
+
+        template <typename U, typename = isConstructible<U>>
+        CBiasedWeakPointer(const CBiasedWeakPointer<U>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                impl_->incWeak();
+        }
+
+        template <typename U, typename = isConstructible<U>>
+        CBiasedWeakPointer(const CBiasedSharedPointer<U>& ref) noexcept : impl_(ref.impl_) {
+            if (impl_)
+                impl_->incWeak();
+        }
+
+        template <typename U, typename = isConstructible<U>>
+        CBiasedWeakPointer(CBiasedWeakPointer<U>&& ref) noexcept {
+            std::swap(impl_, ref.impl_);
+        }
+
+        CBiasedWeakPointer(CBiasedWeakPointer&& ref) noexcept {
+            std::swap(impl_, ref.impl_);
+        }
+
+        CBiasedWeakPointer() noexcept = default;
+
+        CBiasedWeakPointer(std::nullptr_t) noexcept {
+            ; // empty
+        }
+
+        ~CBiasedWeakPointer() {
+            reset();
+        }
+
+        template <typename U>
+        validHierarchy<const CBiasedWeakPointer<U>&> operator=(const CBiasedWeakPointer<U>& rhs) {
+            CBiasedWeakPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
+            return *this;
+        }
+
+        CBiasedWeakPointer& operator=(const CBiasedWeakPointer& rhs) {
+            if (this == &rhs)
+                return *this;
+
+            CBiasedWeakPointer<T> copy(rhs);
+            std::swap(impl_, copy.impl_);
+            return *this;
+        }
+
+        template <typename U>
+        validHierarchy<const CBiasedWeakPointer<U>&> operator=(CBiasedWeakPointer<U>&& rhs) noexcept {
+            std::swap(impl_, rhs.impl_);
+            return *this;
+        }
+
+        CBiasedWeakPointer& operator=(CBiasedWeakPointer&& rhs) noexcept {
+            if (this == &rhs)
+                return *this;
+
+            std::swap(impl_, rhs.impl_);
+            return *this;
+        }
+
+        void reset() {
+            if (!impl_)
+                return;
+
+            std::exchange(impl_, nullptr)->decWeak();
+        }
+
+        bool expired() const {
+            return !valid();
+        }
+
+        /* a strong ref existed at the time of the call. It may be gone by the time this returns. */
+        bool valid() const {
+            return impl_ && impl_->alive();
+        }
+
+        operator bool() const {
+            return valid();
+        }
+
+        bool operator==(const CBiasedWeakPointer& rhs) const {
+            return impl_ == rhs.impl_;
+        }
+
+        bool operator==(const CBiasedSharedPointer<T>& rhs) const {
+            return impl_ == rhs.impl_;
+        }
+
+        CBiasedSharedPointer<T> lock() const {
+            if (!impl_ || !impl_->tryInc())
+                return {};
+
+            return CBiasedSharedPointer<T>(impl_, typename CBiasedSharedPointer<T>::SAdopt{});
+        }
+
+      private:
+        Biased_::impl* impl_ = nullptr;
+
+        template <typename U>
+        friend class CBiasedWeakPointer;
+    };
+
+    /* the calling thread becomes the owner */
+    template <typename U, typename... Args>
+    [[nodiscard]] inline CBiasedSharedPointer<U> makeBiasedShared(Args&&... args) {
+        return CBiasedSharedPointer<U>(new U(std::forward<Args>(args)...));
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "SharedPtr.hpp"
+
+/*
+    Moves the destruction of big objects out of the code that drops the last ref to them.
+
+    Objects opt in with deferDestruction(). When the last CSharedPointer to such an object dies
+    on a thread that has a CDeferredReclaimer installed, the control block is queued on the reclaimer
+    instead of running the destructor. The owner of the reclaimer then drains it at a safe point,
+    e.g. at the end of a frame, optionally within a time budget.
+
+    A queued object behaves like one that was destroyed: weak pointers see it as expired, are no longer
+    valid() and can't lock it anymore. Without a reclaimer on the thread, the object is destroyed right away as usual.
+
+    Only CSharedPointer defers, atomic and unique pointers ignore the opt-in.
+*/
+
+namespace Hyprutils::Memory {
+    class CDeferredReclaimer {
+      public:
+        /* installs this as the reclaimer of the calling thread, until it's destroyed */
+        CDeferredReclaimer();
+        /* destroys everything still queued and reinstalls the previous reclaimer.
+           Has to run on the thread that created it. */
+        ~CDeferredReclaimer();
+
+        CDeferredReclaimer(const CDeferredReclaimer&)            = delete;
+        CDeferredReclaimer(CDeferredReclaimer&&)                 = delete;
+        CDeferredReclaimer& operator=(const CDeferredReclaimer&) = delete;
+        CDeferredReclaimer& operator=(CDeferredReclaimer&&)      = delete;
+
+        /* destroys all queued objects, including ones queued by the destructors it runs.
+           Returns the amount of objects destroyed. */
+        size_t drain();
+
+        /* same as drain(), but stops once the budget is used up.
+           At least one object is destroyed per call, so the queue always makes progress. */
+        size_t drain(std::chrono::nanoseconds budget);
+
+        /* objects waiting to be destroyed */
+        size_t pending() const;
+
+        /* the reclaimer of the calling thread, or nullptr */
+        static CDeferredReclaimer* current();
+
+      private:
+        size_t                          drainUntil(std::chrono::steady_clock::time_point deadline, bool bounded);
+
+        std::vector<Impl_::impl_base*> m_queue;
+        size_t                          m_head     = 0;
+        CDeferredReclaimer*             m_previous = nullptr;
+
+        friend bool Impl_::deferDestroy(Impl_::impl_base* impl);
+    };
+
+    /* lets the thread's reclaimer destroy the object once the last strong ref is gone */
+    template <typename T>
+    void deferDestruction(const CSharedPointer<T>& ptr) {
+        if (ptr.impl_)
+            ptr.impl_->setDeferred();
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+
+/*
+    A bump allocator for objects that live for a single frame, meant for allocateShared / allocateUnique.
+
+    Allocating is a pointer bump, freeing does nothing. reset() rewinds the arena in one go and keeps
+    its memory for the next frame, so a steady workload stops touching the heap after warming up.
+    Everything allocated from the arena has to be gone before reset(), weak pointers included,
+    see live().
+
+    Not thread-safe.
+*/
+
+namespace Hyprutils::Memory {
+    class CFrameArena : public std::pmr::memory_resource {
+      public:
+        /* chunks are taken from upstream, chunkSize bytes at a time unless an allocation needs more */
+        explicit CFrameArena(size_t chunkSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~CFrameArena() override;
+
+        CFrameArena(const CFrameArena&)            = delete;
+        CFrameArena& operator=(const CFrameArena&) = delete;
+
+        /* rewinds to the start, keeping the chunks */
+        void reset();
+
+        /* frees the chunks that weren't used since the last reset */
+        void trim();
+
+        /* allocations not deallocated yet */
+        size_t live() const;
+
+        /* bytes handed out since the last reset */
+        size_t used() const;
+
+        /* bytes held from upstream */
+        size_t capacity() const;
+
+      private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void  do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        struct SChunk {
+            unsigned char* data = nullptr;
+            size_t         size = 0;
+        };
+
+        std::vector<SChunk>        m_chunks;
+        size_t                     m_current   = 0;
+        size_t                     m_offset    = 0;
+        size_t                     m_used      = 0;
+        size_t                     m_live      = 0;
+        size_t                     m_chunkSize = 0;
+        std::pmr::memory_resource* m_upstream  = nullptr;
+    };
+}
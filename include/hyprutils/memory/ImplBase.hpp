@@ -1,20 +1,67 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <new>
+#include <type_traits>
+
+#include "Casts.hpp"
+#include "Instrumentation.hpp"
 
 namespace Hyprutils {
     namespace Memory {
+        struct SControlBlockPoolStats {
+            /* false if built with HYPRUTILS_NO_CONTROL_BLOCK_POOL */
+            bool   enabled = false;
+
+            /* allocations served from the calling thread's free list */
+            size_t hits = 0;
+            /* allocations that had to refill the free list */
+            size_t misses = 0;
+            /* slabs allocated, these are never returned to the system */
+            size_t slabs = 0;
+        };
+
+        /* totals across all threads, including exited ones */
+        SControlBlockPoolStats getControlBlockPoolStats();
+
         namespace Impl_ {
+            /*
+                The control block is 16 bytes: the deleter and two 32-bit refcounts.
+                The flags live in the top bits of the strong refcount, so the strong count is limited to 2^25.
+                The data pointer is not stored:
+                 - fused blocks (see makeFused) keep the data right after the header,
+                 - separately allocated data goes in an impl_separate, which appends the pointer.
+                Flag changes go through atomic ops, so that atomic pointers can use the same block.
+            */
             class impl_base {
               public:
                 using DeleteFn = void (*)(void*);
 
-                impl_base(void* data, DeleteFn deleter, bool lock = true) noexcept : _lockable(lock), _data(data), _deleter(deleter) {
-                    ;
-                }
+                /* the data is being destroyed, creating shared_ptrs is no longer valid */
+                static constexpr unsigned int FLAG_DESTROYING = 1U << 31;
+                /* the data was destroyed */
+                static constexpr unsigned int FLAG_DESTROYED = 1U << 30;
+                /* the data is allocated together with this block */
+                static constexpr unsigned int FLAG_FUSED = 1U << 29;
+                /* not lockable (unique) */
+                static constexpr unsigned int FLAG_UNLOCKABLE = 1U << 28;
+                /* destruction may be handed to a CDeferredReclaimer */
+                static constexpr unsigned int FLAG_DEFERRED = 1U << 27;
+                /* waiting in a CDeferredReclaimer, counts as destroying */
+                static constexpr unsigned int FLAG_QUEUED = 1U << 26;
+                /* fused block that came from a memory resource, see Allocator.hpp */
+                static constexpr unsigned int FLAG_ALLOCATED = 1U << 25;
+                /* the bits of _ref that hold the strong count */
+                static constexpr unsigned int REF_MASK = FLAG_ALLOCATED - 1;
 
                 void inc() noexcept {
+                    // one more would spill into the flags
+                    if ((_ref & REF_MASK) == REF_MASK) [[unlikely]]
+                        std::abort();
+
                     _ref++;
                 }
 
@@ -31,67 +78,276 @@ namespace Hyprutils {
                 }
 
                 unsigned int ref() noexcept {
-                    return _ref;
+                    return _ref & REF_MASK;
                 }
 
                 unsigned int wref() noexcept {
                     return _weak;
                 }
 
+                /* atomic views of the refcounts, used by the Atomic_ pointers.
+                   A block is either refcounted atomically or not, never both.
+                   The strong count has to be masked with REF_MASK. */
+                std::atomic_ref<unsigned int> atomicRef() noexcept {
+                    return std::atomic_ref<unsigned int>(_ref);
+                }
+
+                std::atomic_ref<unsigned int> atomicWref() noexcept {
+                    return std::atomic_ref<unsigned int>(_weak);
+                }
+
                 void destroy() noexcept {
                     _destroy();
                 }
 
                 bool destroying() noexcept {
-                    return _destroying;
+                    return flags() & (FLAG_DESTROYING | FLAG_QUEUED);
+                }
+
+                void setDeferred() noexcept {
+                    atomicRef().fetch_or(FLAG_DEFERRED, std::memory_order_relaxed);
+                }
+
+                bool deferred() noexcept {
+                    return flags() & FLAG_DEFERRED;
+                }
+
+                /* returns false if the block already was queued */
+                bool markQueued() noexcept {
+                    return !(atomicRef().fetch_or(FLAG_QUEUED, std::memory_order_relaxed) & FLAG_QUEUED);
+                }
+
+                /* destroys the data of a block taken out of a reclaimer queue */
+                void destroyQueued() noexcept {
+                    atomicRef().fetch_and(~FLAG_QUEUED, std::memory_order_relaxed);
+                    _destroy();
+                }
+
+                /* a CSelfReferencing object being constructed counts as destroying, see constructFusedData */
+                void markConstructing() noexcept {
+                    atomicRef().fetch_or(FLAG_DESTROYING, std::memory_order_relaxed);
+                }
+
+                /* if the constructor threw, the data counts as destroyed from then on */
+                void markConstructed(bool constructed) noexcept {
+                    atomicRef().fetch_xor(constructed ? FLAG_DESTROYING : FLAG_DESTROYING | FLAG_DESTROYED, std::memory_order_relaxed);
                 }
 
                 bool lockable() noexcept {
-                    return _lockable;
+                    return !(flags() & FLAG_UNLOCKABLE);
+                }
+
+                bool fused() noexcept {
+                    return flags() & FLAG_FUSED;
                 }
 
                 bool dataNonNull() noexcept {
-                    return _data != nullptr;
+                    return getData() != nullptr;
                 }
 
                 void* getData() noexcept {
-                    return _data;
+                    const auto FLAGS = flags();
+
+                    // a queued object is as good as gone, until destroyQueued() brings it back for its destructor
+                    if (FLAGS & (FLAG_DESTROYED | FLAG_QUEUED))
+                        return nullptr;
+
+                    if (FLAGS & FLAG_FUSED)
+                        return rc<unsigned char*>(this) + sizeof(impl_base);
+
+                    return separateData();
                 }
 
                 ~impl_base() {
                     destroy();
                 }
 
+                /* separately allocated blocks come from a per-thread pool, see src/memory/ImplBase.cpp */
+                static void* operator new(size_t size);
+                static void  operator delete(void* p, size_t size) noexcept;
+
+                /* frees the control block. If the data lives in the same
+                   allocation (see makeFused), its storage goes with it. */
+                static void deallocate(impl_base* impl) noexcept;
+
+                /* for the fused factories, which construct the data right after the block */
+                impl_base(DeleteFn deleter, unsigned int flags) noexcept : _deleter(deleter), _ref(flags) {
+                    ;
+                }
+
               private:
-                /* strong refcount */
+                DeleteFn _deleter = nullptr;
+
+                /* strong refcount and flags */
                 unsigned int _ref = 0;
                 /* weak refcount */
                 unsigned int _weak = 0;
-                /* if this is lockable (shared) */
-                bool  _lockable = true;
 
-                void* _data = nullptr;
+                /* relaxed is enough, the flags that matter across threads are only read
+                   after acquiring the strong count */
+                unsigned int flags() noexcept {
+                    return atomicRef().load(std::memory_order_relaxed) & ~REF_MASK;
+                }
 
-                /* if the destructor was called,
-                   creating shared_ptrs is no longer valid */
-                bool _destroying = false;
+                void* separateData() noexcept;
 
-                void _destroy() {
-                    if (!_data || _destroying)
+                void  _destroy() {
+                    if (flags() & (FLAG_DESTROYING | FLAG_DESTROYED))
                         return;
 
+                    void* data = getData();
+
                     // first, we destroy the data, but keep the pointer.
                     // this way, weak pointers will still be able to
                     // reference and use, but no longer create shared ones.
-                    _destroying = true;
-                    _deleter(_data);
-                    // now, we can reset the data and call it a day.
-                    _data       = nullptr;
-                    _destroying = false;
+                    atomicRef().fetch_or(FLAG_DESTROYING, std::memory_order_relaxed);
+                    _deleter(data);
+                    // now, we can mark the data gone and call it a day.
+                    atomicRef().fetch_xor(FLAG_DESTROYING | FLAG_DESTROYED, std::memory_order_release);
+
+                    if constexpr (INSTRUMENTED)
+                        trackDataDestroyed(this);
                 }
+            };
 
-                DeleteFn _deleter = nullptr;
+            /* a block for data that was allocated on its own, e.g. CSharedPointer(new T) */
+            class impl_separate final : public impl_base {
+              public:
+                // a null pointer counts as destroyed from the start
+                impl_separate(void* data, DeleteFn deleter, bool lock = true) noexcept :
+                    impl_base(deleter, (lock ? 0 : FLAG_UNLOCKABLE) | (data ? 0 : FLAG_DESTROYED)), _data(data) {
+                    ;
+                }
+
+                // destroy while _data is still around, ~impl_base won't need it then
+                ~impl_separate() {
+                    destroy();
+                }
+
+              private:
+                void* _data = nullptr;
+
+                friend class impl_base;
             };
+
+            static_assert(sizeof(impl_base) == 16);
+
+            /* frees a block that came from a memory resource, see Allocator.hpp */
+            void deallocateAllocated(impl_base* impl) noexcept;
+
+            /* storage of fused blocks, and freeing separate ones. Out of line, so that the compiler
+               never pairs the pooled operator new of impl_separate with the plain delete of a fused block. */
+            void* allocateFused(size_t size);
+            void  freeFused(void* block) noexcept;
+            void  freeSeparate(impl_base* impl) noexcept;
+
+            /* queues the block on the calling thread's CDeferredReclaimer. Returns false if there is none. */
+            bool deferDestroy(impl_base* impl);
+            static_assert(alignof(unsigned int) >= std::atomic_ref<unsigned int>::required_alignment);
+
+            inline void* impl_base::separateData() noexcept {
+                return sc<impl_separate*>(this)->_data;
+            }
+
+            inline void impl_base::deallocate(impl_base* impl) noexcept {
+                if constexpr (INSTRUMENTED)
+                    trackFree(impl);
+
+                if (!impl->fused()) {
+                    freeSeparate(impl);
+                    return;
+                }
+
+                if (impl->flags() & FLAG_ALLOCATED) {
+                    deallocateAllocated(impl);
+                    return;
+                }
+
+                impl->~impl_base();
+                freeFused(impl);
+            }
+
+            /* registers a new block with the instrumentation, if enabled */
+            template <typename T>
+            impl_base* tracked(impl_base* impl) {
+                if constexpr (INSTRUMENTED)
+                    trackCreate(impl, typeName<T>(), sizeof(T));
+                return impl;
+            }
+
+            /* base of CSelfReferencing, see SelfReferencing.hpp */
+            struct self_referencing_base {};
+
+            /* the data a fused factory is constructing, if it is self referencing */
+            inline thread_local void* constructingSelfReferencing = nullptr;
+
+            /* constructs the data of a fused block, letting a CSelfReferencing base know where it lives */
+            template <typename T, typename... Args>
+            void constructFusedData(void* data, Args&&... args) {
+                if constexpr (std::is_base_of_v<self_referencing_base, T>) {
+                    struct SRestore {
+                        void* previous = nullptr;
+                        ~SRestore() {
+                            constructingSelfReferencing = previous;
+                        }
+                    } restore{constructingSelfReferencing};
+
+                    // no strong refs until T is done, and weak refs taken by its constructor must not free the block.
+                    // If it throws, they keep the block alive instead, the factory only frees it if there are none.
+                    auto impl = rc<impl_base*>(sc<unsigned char*>(data) - sizeof(impl_base));
+                    impl->markConstructing();
+                    constructingSelfReferencing = data;
+
+                    try {
+                        new (data) T(std::forward<Args>(args)...);
+                    } catch (...) {
+                        impl->markConstructed(false);
+                        throw;
+                    }
+
+                    impl->markConstructed(true);
+                } else
+                    new (data) T(std::forward<Args>(args)...);
+            }
+
+            /* fused data sits right after the header, so it can't be aligned to more than the header size */
+            template <typename T>
+            constexpr bool fusable() {
+                return alignof(T) <= sizeof(impl_base) && alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+            }
+
+            /*
+                allocates the control block and the T it manages in a single block:
+                [impl_base][T]
+                The deleter only runs ~T(), the storage is released with the
+                control block once the last weak ref is gone. This way, weak pointers
+                can still deref the data inside ~T(), same as with a separate allocation.
+                Overaligned types fall back to two allocations.
+            */
+            template <typename T, typename... Args>
+            impl_base* makeFused(bool lockable, Args&&... args) {
+                if constexpr (!fusable<T>()) {
+                    return tracked<T>(new impl_separate(
+                        sc<void*>(new T(std::forward<Args>(args)...)), [](void* p) { std::default_delete<T>{}(sc<T*>(p)); }, lockable));
+                } else {
+                    void* block = allocateFused(sizeof(impl_base) + sizeof(T));
+                    void* data  = sc<unsigned char*>(block) + sizeof(impl_base);
+
+                    // the block goes first, T may take weak refs to itself while being constructed
+                    auto impl = ::new (block) impl_base([](void* p) { std::destroy_at(sc<T*>(p)); }, impl_base::FLAG_FUSED | (lockable ? 0 : impl_base::FLAG_UNLOCKABLE));
+
+                    try {
+                        constructFusedData<T>(data, std::forward<Args>(args)...);
+                    } catch (...) {
+                        // no ~impl_base(), there is no T to destroy. Weak refs the constructor took free the block themselves.
+                        if (impl->wref() == 0)
+                            freeFused(block);
+                        throw;
+                    }
+
+                    return tracked<T>(impl);
+                }
+            }
         }
     }
 
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    Opt-in bookkeeping of control blocks, for tracking down leaks and memory growth.
+
+    Define HYPRUTILS_MEMORY_INSTRUMENTATION (or configure with -DMEMORY_INSTRUMENTATION=ON) before including
+    any memory header. The definition has to be the same in every translation unit, including the library itself.
+    Without it, the hooks compile to nothing.
+
+    Every block is registered in a global table with its type, size and creation time, which makes
+    creating and freeing blocks a lot slower. A block whose data was destroyed but which is kept alive
+    by weak pointers counts as a zombie.
+*/
+
+namespace Hyprutils::Memory {
+    struct SMemoryTypeStats {
+        std::string_view type;
+
+        /* control blocks alive right now, zombies included */
+        size_t live = 0;
+        /* highest live count seen */
+        size_t peak = 0;
+        /* control blocks created so far */
+        size_t total = 0;
+        /* live blocks whose data is gone */
+        size_t zombies = 0;
+    };
+
+    struct SMemorySnapshot {
+        size_t                        liveBlocks   = 0;
+        size_t                        peakBlocks   = 0;
+        size_t                        zombieBlocks = 0;
+
+        /* sorted by live count, most first */
+        std::vector<SMemoryTypeStats> types;
+
+        /* objects created with a size in [2^i, 2^(i+1)) bytes */
+        std::array<size_t, 32> sizes = {};
+        /* objects destroyed after living for [2^i, 2^(i+1)) microseconds, bucket 0 includes anything below 1us */
+        std::array<size_t, 32> lifetimes = {};
+    };
+
+    /* empty if nothing was instrumented */
+    SMemorySnapshot getMemorySnapshot();
+
+    /* a human readable version of a snapshot, one line per type */
+    std::string dumpMemorySnapshot(const SMemorySnapshot& snapshot);
+
+    namespace Impl_ {
+#ifdef HYPRUTILS_MEMORY_INSTRUMENTATION
+        constexpr bool INSTRUMENTED = true;
+#else
+        constexpr bool INSTRUMENTED = false;
+#endif
+
+        void trackCreate(const void* impl, std::string_view type, size_t size);
+        void trackDataDestroyed(const void* impl);
+        void trackFree(const void* impl);
+
+        /* the name of T, without RTTI */
+        template <typename T>
+        constexpr std::string_view typeName() {
+            constexpr std::string_view NAME = __PRETTY_FUNCTION__;
+            constexpr auto             BEGIN = NAME.find("T = ") + 4;
+            constexpr auto             END   = NAME.find_first_of(";]", BEGIN);
+            return NAME.substr(BEGIN, END - BEGIN);
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "UniquePtr.hpp"
+
+/*
+    Recycles objects that are created and destroyed all the time.
+
+    CObjectPool<CRenderElement> pool;
+    auto element = pool.acquire(args...); // a CUniquePointer<CRenderElement>
+
+    When the pointer dies, the object goes back to the pool instead of being freed, and a later acquire()
+    reuses its storage. Control blocks come from the control block pool, so once the pool is warmed up,
+    acquiring and returning objects doesn't allocate.
+
+    Every acquire() gets a new control block, so weak pointers to an object that went back to the pool
+    are expired, and stay expired when the object is handed out again.
+
+    The pool may die before the objects it handed out, those are freed when they come back.
+*/
+
+namespace Hyprutils::Memory {
+    struct SObjectPoolOptions {
+        /* destroy objects when they come back, so every acquire() constructs a fresh one.
+           Otherwise, objects keep their state and acquire() only constructs when there is no idle object. */
+        bool   resetOnReturn = true;
+        /* most idle objects kept around, anything returned beyond that is freed */
+        size_t maxIdle = 1024;
+        /* lock the pool, needed if objects are acquired or destroyed from more than one thread */
+        bool   threadSafe = false;
+    };
+
+    template <typename T>
+    class CObjectPool {
+      public:
+        explicit CObjectPool(SObjectPoolOptions options = {}) : m_state(new SState()) {
+            m_state->options = options;
+        }
+
+        ~CObjectPool() {
+            std::vector<SSlot*> idle;
+            bool                last = false;
+            // once the lock is gone, the last outstanding object may free the state
+            const bool RESET = m_state->options.resetOnReturn;
+
+            {
+                auto lk           = lock(*m_state);
+                m_state->orphaned = true;
+                last              = m_state->outstanding == 0;
+                idle.swap(m_state->idle);
+            }
+
+            freeSlots(idle, RESET);
+
+            if (last)
+                delete m_state;
+        }
+
+        CObjectPool(const CObjectPool&)            = delete;
+        CObjectPool& operator=(const CObjectPool&) = delete;
+
+        /* hands out an idle object, or constructs one with args. See SObjectPoolOptions::resetOnReturn. */
+        template <typename... Args>
+        [[nodiscard]] CUniquePointer<T> acquire(Args&&... args) {
+            static_assert(!std::is_base_of_v<Impl_::self_referencing_base, T>, "pooled objects can't be CSelfReferencing");
+
+            const bool RESET = m_state->options.resetOnReturn;
+            auto       slot  = takeIdle();
+
+            try {
+                if (!slot) {
+                    slot        = new SSlot();
+                    slot->state = m_state;
+                    ::new (slot->storage) T(std::forward<Args>(args)...);
+                } else if (RESET)
+                    ::new (slot->storage) T(std::forward<Args>(args)...);
+            } catch (...) {
+                // the slot holds no object
+                delete slot;
+                auto lk = lock(*m_state);
+                m_state->outstanding--;
+                throw;
+            }
+
+            return CUniquePointer<T>(Impl_::tracked<T>(new Impl_::impl_separate(slot->storage, recycle, false)));
+        }
+
+        /* a pool private to the calling thread. Objects from it have to be destroyed on the same thread. */
+        static CObjectPool& local() {
+            static thread_local CObjectPool pool;
+            return pool;
+        }
+
+        /* objects waiting to be reused */
+        size_t idle() const {
+            auto lk = lock(*m_state);
+            return m_state->idle.size();
+        }
+
+        /* objects handed out and not returned yet */
+        size_t outstanding() const {
+            auto lk = lock(*m_state);
+            return m_state->outstanding;
+        }
+
+        /* frees all idle objects */
+        void trim() {
+            std::vector<SSlot*> idle;
+
+            {
+                auto lk = lock(*m_state);
+                idle.swap(m_state->idle);
+            }
+
+            freeSlots(idle, m_state->options.resetOnReturn);
+        }
+
+      private:
+        struct SSlot;
+
+        /* outlives the pool if objects are still out */
+        struct SState {
+            SObjectPoolOptions  options;
+            std::mutex          mutex;
+            std::vector<SSlot*> idle;
+            size_t              outstanding = 0;
+            bool                orphaned    = false;
+        };
+
+        struct SSlot {
+            SState*                    state = nullptr;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        static std::unique_lock<std::mutex> lock(SState& state) {
+            return state.options.threadSafe ? std::unique_lock(state.mutex) : std::unique_lock<std::mutex>();
+        }
+
+        /* an idle slot or nullptr, counted as outstanding either way */
+        SSlot* takeIdle() {
+            auto lk = lock(*m_state);
+            m_state->outstanding++;
+
+            if (m_state->idle.empty())
+                return nullptr;
+
+            const auto SLOT = m_state->idle.back();
+            m_state->idle.pop_back();
+            return SLOT;
+        }
+
+        static void freeSlots(const std::vector<SSlot*>& slots, bool reset) {
+            for (const auto& slot : slots) {
+                if (!reset)
+                    std::destroy_at(rc<T*>(slot->storage));
+                delete slot;
+            }
+        }
+
+        /* the deleter of pooled objects */
+        static void recycle(void* data) {
+            const auto slot  = rc<SSlot*>(sc<unsigned char*>(data) - offsetof(SSlot, storage));
+            const auto state = slot->state;
+            const bool RESET = state->options.resetOnReturn;
+            bool       kept = false, last = false;
+
+            // not under the lock, ~T may return other objects of this pool
+            if (RESET)
+                std::destroy_at(sc<T*>(data));
+
+            {
+                auto lk = lock(*state);
+                state->outstanding--;
+
+                if (!state->orphaned && state->idle.size() < state->options.maxIdle) {
+                    try {
+                        state->idle.emplace_back(slot);
+                        kept = true;
+                    } catch (...) {
+                        // out of memory, the object is freed instead
+                    }
+                }
+
+                last = state->orphaned && state->outstanding == 0;
+            }
+
+            if (!kept) {
+                if (!RESET)
+                    std::destroy_at(sc<T*>(data));
+                delete slot;
+            }
+
+            if (last)
+                delete state;
+        }
+
+        SState* m_state = nullptr;
+    };
+}
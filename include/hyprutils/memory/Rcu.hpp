@@ -0,0 +1,175 @@
+#pragma once
+
+#include "./Casts.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+/*
+    Read-copy-update pointers for state that is read all the time from many threads and rarely written.
+
+    Readers open a read section with a CRcuReadGuard and get a plain const T* from the pointer.
+    There is no refcounting and no lock: entering and leaving a section is a thread-local store and a fence.
+    The T* may only be used until the section ends.
+
+    Writers swap in a new version. The old one can't be freed while a read section that may have seen it
+    is still open, so it is either freed after waiting for those sections (RCU_SYNCHRONIZE, blocks the writer),
+    or retired and freed later by rcuReclaim() (RCU_DEFER, never blocks).
+
+    This uses epoch based reclamation: there is a single global epoch, and each reader publishes the epoch
+    it entered in. Bumping the epoch and waiting for every reader to leave or to catch up is a grace period.
+
+    Read sections nest. Writers must not block on a grace period from inside a read section, that throws std::logic_error.
+*/
+
+namespace Hyprutils::Memory {
+    namespace Rcu_ {
+        struct SReader {
+            /* epoch the thread entered its read section in, 0 outside of one */
+            std::atomic<uint64_t> epoch   = 0;
+            size_t                nesting = 0;
+        };
+
+        inline std::atomic<uint64_t> globalEpoch = 1;
+
+        /* the reader state of the calling thread, if it ever read */
+        inline thread_local SReader* tlsReader = nullptr;
+
+        SReader*                     registerReader();
+
+        /* hands a retired object to the reclaimer */
+        void retire(void* p, void (*deleter)(void*));
+
+        inline void readLock() noexcept {
+            auto reader = tlsReader ? tlsReader : registerReader();
+            if (reader->nesting++ > 0)
+                return;
+
+            reader->epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            // order the epoch store before any load of an rcu pointer, pairs with the grace period in rcuSynchronize
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        inline void readUnlock() noexcept {
+            if (--tlsReader->nesting > 0)
+                return;
+
+            tlsReader->epoch.store(0, std::memory_order_release);
+        }
+
+        inline bool insideReadSection() noexcept {
+            return tlsReader && tlsReader->nesting > 0;
+        }
+    }
+
+    /* waits until every read section open at the time of the call has ended, then frees what was retired before */
+    void rcuSynchronize();
+
+    /* frees retired objects no reader can see anymore, without waiting. Returns the amount freed. */
+    size_t rcuReclaim();
+
+    /* retired objects waiting to be freed */
+    size_t rcuPending();
+
+    class CRcuReadGuard {
+      public:
+        CRcuReadGuard() noexcept {
+            Rcu_::readLock();
+        }
+
+        ~CRcuReadGuard() {
+            Rcu_::readUnlock();
+        }
+
+        CRcuReadGuard(const CRcuReadGuard&)            = delete;
+        CRcuReadGuard& operator=(const CRcuReadGuard&) = delete;
+    };
+
+    enum eRcuReclaim : uint8_t {
+        RCU_SYNCHRONIZE = 0, /* wait for a grace period, then free */
+        RCU_DEFER,           /* retire, freed by a later rcuReclaim() or rcuSynchronize() */
+    };
+
+    template <typename T>
+    class CRcuPointer {
+      public:
+        CRcuPointer() = default;
+
+        /* takes ownership */
+        explicit CRcuPointer(T* value) noexcept : m_value(value) {
+            ;
+        }
+
+        /* nobody may be reading anymore */
+        ~CRcuPointer() {
+            delete m_value.load(std::memory_order_relaxed);
+        }
+
+        CRcuPointer(const CRcuPointer&)            = delete;
+        CRcuPointer& operator=(const CRcuPointer&) = delete;
+
+        /* the current version. Only valid inside a read section, see CRcuReadGuard. */
+        const T* read() const noexcept {
+            return m_value.load(std::memory_order_acquire);
+        }
+
+        /* publishes a new version, taking ownership of it. If this throws, nothing was published and value is freed. */
+        void update(T* value, eRcuReclaim mode = RCU_SYNCHRONIZE) {
+            std::unique_ptr<T> next(value);
+            checkMode(mode);
+
+            std::unique_lock lk(m_writeMutex);
+            const auto       OLD = m_value.exchange(next.release(), std::memory_order_acq_rel);
+            lk.unlock();
+
+            reclaim(OLD, mode);
+        }
+
+        template <typename... Args>
+        void emplace(eRcuReclaim mode, Args&&... args) {
+            update(new T(std::forward<Args>(args)...), mode);
+        }
+
+        /* copies the current version, lets fn change the copy and publishes it.
+           Concurrent calls to modify() are serialized, so no change gets lost. If fn throws, nothing is published. */
+        template <typename Fn>
+        void modify(Fn&& fn, eRcuReclaim mode = RCU_SYNCHRONIZE) {
+            checkMode(mode);
+
+            std::unique_lock lk(m_writeMutex);
+
+            const auto       CURRENT = m_value.load(std::memory_order_acquire);
+            auto             next    = CURRENT ? std::make_unique<T>(*CURRENT) : std::make_unique<T>();
+            fn(*next);
+
+            m_value.store(next.release(), std::memory_order_release);
+            lk.unlock();
+
+            reclaim(CURRENT, mode);
+        }
+
+      private:
+        // checked before publishing, so that a failed update leaves everything as it was
+        static void checkMode(eRcuReclaim mode) {
+            if (mode == RCU_SYNCHRONIZE && Rcu_::insideReadSection())
+                throw std::logic_error("CRcuPointer: synchronous update inside a read section");
+        }
+
+        static void reclaim(T* old, eRcuReclaim mode) {
+            if (!old)
+                return;
+
+            if (mode == RCU_SYNCHRONIZE) {
+                rcuSynchronize();
+                delete old;
+            } else
+                Rcu_::retire(old, [](void* p) { delete sc<T*>(p); });
+        }
+
+        std::atomic<T*> m_value = nullptr;
+        std::mutex      m_writeMutex;
+    };
+}
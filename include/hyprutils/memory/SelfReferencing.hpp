@@ -0,0 +1,73 @@
+#pragma once
+
+#include <new>
+#include <stdexcept>
+
+#include "WeakPtr.hpp"
+
+/*
+    Lets an object get pointers to itself without storing any, like std::enable_shared_from_this.
+
+    class CWindow : public CSelfReferencing<CWindow> { ... };
+    auto window = makeShared<CWindow>();
+    window->self(); // == CWeakPointer<CWindow>(window)
+
+    The control block is found right in front of the object, so this only works for objects
+    created by makeShared, makeUnique, allocateShared or allocateUnique. Constructing one any
+    other way (on the stack, as a member, with new) throws std::logic_error.
+    Same as with the pointers, the CSelfReferencing base has to sit at the start of the
+    allocated object, i.e. it should be the first base class.
+*/
+
+namespace Hyprutils::Memory {
+    template <typename T>
+    class CSelfReferencing : public Impl_::self_referencing_base {
+      public:
+        /* a weak pointer to this object. Valid, but expired, inside the constructor and the destructor. */
+        CWeakPointer<T> self() const {
+            return CWeakPointer<T>(impl());
+        }
+
+        /* a strong pointer to this object, empty if it's unique or being constructed or destroyed */
+        CSharedPointer<T> sharedSelf() const {
+            // same as self().lock(), without the weak ref round trip
+            const auto IMPL = impl();
+            if (!IMPL->dataNonNull() || IMPL->destroying() || !IMPL->lockable())
+                return {};
+
+            return CSharedPointer<T>(IMPL);
+        }
+
+      protected:
+        CSelfReferencing() {
+            claim();
+        }
+
+        CSelfReferencing(const CSelfReferencing&) {
+            claim();
+        }
+
+        CSelfReferencing& operator=(const CSelfReferencing&) {
+            return *this;
+        }
+
+        ~CSelfReferencing() = default;
+
+      private:
+        Impl_::impl_base* impl() const {
+            static_assert(Impl_::fusable<T>(), "CSelfReferencing doesn't support overaligned types");
+            // laundered, so the compiler doesn't judge the arithmetic by the bounds of this base
+            const auto BYTES = std::launder(rc<unsigned char*>(cc<CSelfReferencing*>(this)));
+            return rc<Impl_::impl_base*>(BYTES - sizeof(Impl_::impl_base));
+        }
+
+        /* makes sure a fused factory is constructing this, at the start of its block */
+        void claim() {
+            if (Impl_::constructingSelfReferencing != cc<CSelfReferencing*>(this))
+                throw std::logic_error("CSelfReferencing objects have to be created with makeShared or makeUnique");
+
+            // members and later objects have to match their own factory
+            Impl_::constructingSelfReferencing = nullptr;
+        }
+    };
+}
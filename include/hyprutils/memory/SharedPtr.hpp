@@ -13,6 +13,12 @@
     namely in the fact that it keeps the T* inside the
     control block, and that you can still make a CWeakPtr
     or deref an existing one inside the destructor.
+
+    makeShared places the control block and the object in a single
+    allocation. The object is destroyed when the last strong ref dies,
+    the allocation itself is freed when the last weak ref dies.
+
+    The strong count of one object is limited to 2^25 - 1, taking one more aborts.
 */
 
 namespace Hyprutils {
@@ -28,7 +34,7 @@ namespace Hyprutils {
 
             /* creates a new shared pointer managing a resource
                avoid calling. Could duplicate ownership. Prefer makeShared */
-            explicit CSharedPointer(T* object) noexcept : impl_(new Impl_::impl_base(sc<void*>(object), _delete)) {
+            explicit CSharedPointer(T* object) noexcept : impl_(Impl_::tracked<T>(new Impl_::impl_separate(sc<void*>(object), _delete))) {
                 increment();
             }
 
@@ -170,20 +176,25 @@ namespace Hyprutils {
             /* destroy the pointed-to object
                if able, will also destroy impl */
             void destroyImpl() {
+                // opted in objects are destroyed when the reclaimer drains, see DeferredReclaimer.hpp
+                if (impl_->deferred() && Impl_::deferDestroy(impl_))
+                    return;
+
                 // destroy the impl contents
                 impl_->destroy();
 
                 // check for weak refs, if zero, we can also delete impl_
                 if (impl_->wref() == 0) {
-                    delete impl_;
+                    Impl_::impl_base::deallocate(impl_);
                     impl_ = nullptr;
                 }
             }
         };
 
+        /* allocates the object and its control block in one go */
         template <typename U, typename... Args>
         [[nodiscard]] inline CSharedPointer<U> makeShared(Args&&... args) {
-            return CSharedPointer<U>(new U(std::forward<Args>(args)...));
+            return CSharedPointer<U>(Impl_::makeFused<U>(true, std::forward<Args>(args)...));
         }
 
         template <typename T, typename U>
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Casts.hpp"
+
+/*
+    A container for objects that are referred to by handle instead of by pointer.
+
+    Values live in one dense vector, so iterating only visits live values and is as cache friendly as it gets.
+    Handles go through a slot table to find their value. Inserting and erasing are O(1): erasing moves
+    the last value into the hole, so the order of values is not stable.
+
+    Every slot has a generation that changes when its value is erased. A handle remembers the generation
+    it was created with, so a handle to an erased value stays invalid, even if the slot gets reused.
+
+    Pointers and references to values are invalidated by insert and erase, handles are not.
+*/
+
+namespace Hyprutils::Memory {
+    struct SSlotHandle {
+        uint32_t index      = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool     operator==(const SSlotHandle&) const = default;
+    };
+
+    template <typename T>
+    class CSlotMap {
+      public:
+        using iterator       = typename std::vector<T>::iterator;
+        using const_iterator = typename std::vector<T>::const_iterator;
+
+        template <typename... Args>
+        SSlotHandle emplace(Args&&... args) {
+            uint32_t slotIdx = 0;
+
+            if (m_freeHead != UINT32_MAX) {
+                slotIdx    = m_freeHead;
+                m_freeHead = m_slots[slotIdx].target;
+            } else {
+                slotIdx = sc<uint32_t>(m_slots.size());
+                m_slots.emplace_back();
+            }
+
+            try {
+                m_data.emplace_back(std::forward<Args>(args)...);
+                m_dataSlots.emplace_back(slotIdx);
+            } catch (...) {
+                if (m_data.size() > m_dataSlots.size())
+                    m_data.pop_back();
+
+                // the slot was never occupied, its generation is still even
+                m_slots[slotIdx].target = m_freeHead;
+                m_freeHead              = slotIdx;
+                throw;
+            }
+
+            auto& slot  = m_slots[slotIdx];
+            slot.target = sc<uint32_t>(m_data.size() - 1);
+            slot.generation |= 1; // odd generations are occupied
+
+            return {.index = slotIdx, .generation = slot.generation};
+        }
+
+        SSlotHandle insert(const T& value) {
+            return emplace(value);
+        }
+
+        SSlotHandle insert(T&& value) {
+            return emplace(std::move(value));
+        }
+
+        /* returns false if the handle was stale */
+        bool erase(const SSlotHandle& handle) {
+            if (!contains(handle))
+                return false;
+
+            eraseSlot(handle.index);
+            return true;
+        }
+
+        /* erases the value an iterator points to, returns an iterator to the next value to visit */
+        iterator erase(const_iterator it) {
+            const auto DATAIDX = sc<size_t>(it - m_data.cbegin());
+            eraseSlot(m_dataSlots[DATAIDX]);
+            return m_data.begin() + DATAIDX;
+        }
+
+        /* erases every value matching the predicate, returns the amount erased */
+        template <typename Pred>
+        size_t eraseIf(Pred&& pred) {
+            size_t erased = 0;
+            for (size_t i = 0; i < m_data.size();) {
+                if (pred(m_data[i])) {
+                    eraseSlot(m_dataSlots[i]);
+                    erased++;
+                } else
+                    i++;
+            }
+            return erased;
+        }
+
+        bool contains(const SSlotHandle& handle) const {
+            return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation && (handle.generation & 1);
+        }
+
+        /* nullptr if the handle is stale */
+        T* get(const SSlotHandle& handle) {
+            return contains(handle) ? &m_data[m_slots[handle.index].target] : nullptr;
+        }
+
+        const T* get(const SSlotHandle& handle) const {
+            return contains(handle) ? &m_data[m_slots[handle.index].target] : nullptr;
+        }
+
+        /* the handle of a value, by its position in iteration order */
+        SSlotHandle handleAt(size_t dataIdx) const {
+            const auto SLOTIDX = m_dataSlots[dataIdx];
+            return {.index = SLOTIDX, .generation = m_slots[SLOTIDX].generation};
+        }
+
+        void clear() {
+            for (size_t i = m_data.size(); i > 0; --i) {
+                eraseSlot(m_dataSlots[i - 1]);
+            }
+        }
+
+        void reserve(size_t n) {
+            m_data.reserve(n);
+            m_dataSlots.reserve(n);
+            m_slots.reserve(n);
+        }
+
+        size_t size() const {
+            return m_data.size();
+        }
+
+        bool empty() const {
+            return m_data.empty();
+        }
+
+        T* data() {
+            return m_data.data();
+        }
+
+        const T* data() const {
+            return m_data.data();
+        }
+
+        iterator begin() {
+            return m_data.begin();
+        }
+
+        iterator end() {
+            return m_data.end();
+        }
+
+        const_iterator begin() const {
+            return m_data.begin();
+        }
+
+        const_iterator end() const {
+            return m_data.end();
+        }
+
+      private:
+        struct SSlot {
+            /* index into m_data if occupied, next free slot otherwise */
+            uint32_t target     = UINT32_MAX;
+            uint32_t generation = 0;
+        };
+
+        void eraseSlot(uint32_t slotIdx) {
+            auto&      slot    = m_slots[slotIdx];
+            const auto DATAIDX = slot.target;
+            const auto LASTIDX = sc<uint32_t>(m_data.size() - 1);
+
+            // move the last value into the hole
+            if (DATAIDX != LASTIDX) {
+                m_data[DATAIDX]                      = std::move(m_data[LASTIDX]);
+                m_dataSlots[DATAIDX]                 = m_dataSlots[LASTIDX];
+                m_slots[m_dataSlots[DATAIDX]].target = DATAIDX;
+            }
+
+            m_data.pop_back();
+            m_dataSlots.pop_back();
+
+            slot.generation++; // even: free
+            slot.target = m_freeHead;
+            m_freeHead  = slotIdx;
+        }
+
+        std::vector<T>        m_data;
+        /* slot of each value in m_data */
+        std::vector<uint32_t> m_dataSlots;
+        std::vector<SSlot>    m_slots;
+        uint32_t              m_freeHead = UINT32_MAX;
+    };
+}
@@ -22,7 +22,12 @@ namespace Hyprutils {
 
             /* creates a new unique pointer managing a resource
                avoid calling. Could duplicate ownership. Prefer makeUnique */
-            explicit CUniquePointer(T* object) noexcept : impl_(new Impl_::impl_base(sc<void*>(object), [](void* p) { std::default_delete<T>{}(sc<T*>(p)); }, false)) {
+            explicit CUniquePointer(T* object) noexcept : impl_(Impl_::tracked<T>(new Impl_::impl_separate(sc<void*>(object), [](void* p) { std::default_delete<T>{}(sc<T*>(p)); }, false))) {
+                increment();
+            }
+
+            /* takes ownership of an impl, used by makeUnique */
+            explicit CUniquePointer(Impl_::impl_base* implementation) noexcept : impl_(implementation) {
                 increment();
             }
 
@@ -126,15 +131,16 @@ namespace Hyprutils {
 
                 // check for weak refs, if zero, we can also delete impl_
                 if (impl_->wref() == 0) {
-                    delete impl_;
+                    Impl_::impl_base::deallocate(impl_);
                     impl_ = nullptr;
                 }
             }
         };
 
+        /* allocates the object and its control block in one go */
         template <typename U, typename... Args>
         [[nodiscard]] inline CUniquePointer<U> makeUnique(Args&&... args) {
-            return CUniquePointer<U>(new U(std::forward<Args>(args)...));
+            return CUniquePointer<U>(Impl_::makeFused<U>(false, std::forward<Args>(args)...));
         }
     }
 }
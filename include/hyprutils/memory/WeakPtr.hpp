@@ -101,6 +101,11 @@ namespace Hyprutils {
                 return *this;
             }
 
+            /* create a weak ptr from an impl, used by CSelfReferencing */
+            explicit CWeakPointer(Impl_::impl_base* implementation) noexcept : impl_(implementation) {
+                incrementWeak();
+            }
+
             /* create an empty weak ptr */
             CWeakPointer() noexcept = default;
 
@@ -195,7 +200,7 @@ namespace Hyprutils {
                 // and have a shared_ptr destroy the same thing
                 // later (in situations where we have a weak_ptr to self)
                 if (impl_->wref() == 0 && impl_->ref() == 0 && !impl_->destroying()) {
-                    delete impl_;
+                    Impl_::impl_base::deallocate(impl_);
                     impl_ = nullptr;
                 }
             }
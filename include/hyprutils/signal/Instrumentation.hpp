@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    Opt-in timing of signals and their listeners, for finding out which emits make a frame run long.
+
+    Define HYPRUTILS_SIGNAL_INSTRUMENTATION (or configure with -DSIGNAL_INSTRUMENTATION=ON) before including
+    any signal header. Without it, the hooks compile to nothing. The layout of signals and listeners is the same
+    either way, so code built without it can use an instrumented library, its emits just aren't recorded.
+
+    Signals are recorded under the name given with setName(), unnamed ones all together.
+    Listeners are recorded under the place they were created at, listen() picks it up by itself.
+    Every handler call is timed, which makes emitting noticeably slower.
+*/
+
+namespace Hyprutils::Signal {
+    struct SSignalStats {
+        std::string name;
+
+        size_t      emits = 0;
+        /* handler calls, over all emits */
+        size_t calls = 0;
+        /* most handlers called by a single emit */
+        size_t maxFanOut = 0;
+        /* wall time spent in handlers, over all emits */
+        uint64_t totalNs = 0;
+        /* longest single emit */
+        uint64_t maxNs = 0;
+    };
+
+    struct SListenerStats {
+        /* file:line */
+        std::string location;
+
+        size_t      calls   = 0;
+        uint64_t    totalNs = 0;
+        /* longest single call */
+        uint64_t maxNs = 0;
+    };
+
+    struct SSignalSnapshot {
+        /* both sorted by total time, most first */
+        std::vector<SSignalStats>   signals;
+        std::vector<SListenerStats> listeners;
+    };
+
+    /* empty if nothing was instrumented */
+    SSignalSnapshot getSignalSnapshot();
+
+    /* a human readable version of a snapshot, one line per signal and listener */
+    std::string dumpSignalSnapshot(const SSignalSnapshot& snapshot);
+
+    namespace Impl_ {
+#ifdef HYPRUTILS_SIGNAL_INSTRUMENTATION
+        constexpr bool INSTRUMENTED = true;
+#else
+        constexpr bool INSTRUMENTED = false;
+#endif
+
+        /* records are never freed, signals and listeners keep plain pointers to them */
+        struct SSignalRecord;
+        struct SListenerRecord;
+
+        SSignalRecord*   signalRecord(std::string_view name);
+        SListenerRecord* listenerRecord(const std::source_location& location);
+
+        uint64_t         now();
+        void             recordEmit(SSignalRecord* record, size_t fanOut, uint64_t ns);
+        /* record may be null for listeners created without one */
+        void recordCall(SListenerRecord* record, uint64_t ns);
+    }
+}
@@ -1,15 +1,47 @@
 #pragma once
 
 #include <any>
-#include <functional>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/SelfReferencing.hpp>
+#include <hyprutils/utils/Function.hpp>
+#include "./Instrumentation.hpp"
 
 namespace Hyprutils {
     namespace Signal {
         class CSignalBase;
+        class CSignalListener;
 
-        class CSignalListener {
+        /*
+            The listeners of a signal, linked through the listeners themselves.
+            A listener unlinks itself when it dies, so the list only ever holds live ones.
+        */
+        struct SListenerList {
+            CSignalListener* head = nullptr;
+            CSignalListener* tail = nullptr;
+            /* bumped for every listener added, see CSignalBase::emitInternal */
+            uint64_t generation = 0;
+
+            /* keeps the list sorted by priority, highest first, and in insertion order within one */
+            void insert(CSignalListener* listener, int32_t priority);
+            void unlink(CSignalListener* listener);
+            /* hands all listeners over to another list */
+            void moveTo(SListenerList& other);
+            /* unlinks all listeners, leaving them alone otherwise */
+            void detachAll();
+        };
+
+        /*
+            The type-erased side of a listener, what CHyprSignalListener points to.
+            Listeners are always created by makeShared, which lets an emit take a strong ref to the one it calls.
+        */
+        class CSignalListener : public Memory::CSelfReferencing<CSignalListener> {
           public:
+            ~CSignalListener();
+
             CSignalListener(CSignalListener&&)       = delete;
             CSignalListener(CSignalListener&)        = delete;
             CSignalListener(const CSignalListener&)  = delete;
@@ -17,16 +49,75 @@ namespace Hyprutils {
 
             [[deprecated("Relic of the legacy untyped signal API. Using this with CSignalT is undefined behavior.")]] void emit(std::any data);
 
-          private:
-            CSignalListener(std::function<void(void*)> handler);
+          protected:
+            using UntypedFn = void (*)(CSignalListener* listener, void* args);
+
+            CSignalListener(UntypedFn untyped) : m_fUntyped(untyped) {
+                ;
+            }
 
-            void                       emitInternal(void* args);
+            /* the UntypedFn of a listener type with a call(Args...) */
+            template <typename Self, typename... Args>
+            static void callUntyped(CSignalListener* listener, void* args) {
+                auto self = Memory::sc<Self*>(listener);
 
-            std::function<void(void*)> m_fHandler;
+                if constexpr (sizeof...(Args) == 0)
+                    self->call();
+                else if constexpr (sizeof...(Args) == 1)
+                    self->call(*Memory::sc<std::remove_reference_t<Args>*...>(args));
+                else
+                    std::apply([self](Args... a) { self->call(std::forward<Args>(a)...); }, *Memory::sc<std::tuple<Args...>*>(args));
+            }
 
+          private:
+            /* calls the handler with arguments behind a void*, only for the legacy emit() */
+            UntypedFn        m_fUntyped = nullptr;
+
+            SListenerList*   m_pList      = nullptr;
+            CSignalListener* m_pPrev      = nullptr;
+            CSignalListener* m_pNext      = nullptr;
+            uint64_t         m_generation = 0;
+            int32_t          m_priority   = 0;
+            /* null without instrumentation, see CSignalBase::m_pRecord */
+            Impl_::SListenerRecord* m_pRecord = nullptr;
+
+            friend struct SListenerList;
             friend class CSignalBase;
         };
 
+        /* a listener with a handler typed on the arguments of its signal, see CSignalT */
+        template <typename... Args>
+        class CSignalListenerT : public CSignalListener {
+          public:
+            CSignalListenerT(Utils::CFunction<void(Args...)> handler) : CSignalListener(&callUntyped<CSignalListenerT, Args...>), m_fHandler(std::move(handler)) {
+                ;
+            }
+
+            void call(Args... args) {
+                if (m_fHandler)
+                    m_fHandler(std::forward<Args>(args)...);
+            }
+
+          private:
+            Utils::CFunction<void(Args...)> m_fHandler;
+        };
+
+        /* a listener whose handler returns whether it consumed the event, see CConsumableSignalT */
+        template <typename... Args>
+        class CConsumableListenerT : public CSignalListener {
+          public:
+            CConsumableListenerT(Utils::CFunction<bool(Args...)> handler) : CSignalListener(&callUntyped<CConsumableListenerT, Args...>), m_fHandler(std::move(handler)) {
+                ;
+            }
+
+            bool call(Args... args) {
+                return m_fHandler && m_fHandler(std::forward<Args>(args)...);
+            }
+
+          private:
+            Utils::CFunction<bool(Args...)> m_fHandler;
+        };
+
         typedef Hyprutils::Memory::CSharedPointer<CSignalListener> CHyprSignalListener;
     }
 }
@@ -1,56 +1,283 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <functional>
 #include <any>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include <memory>
+#include <source_location>
+#include <string_view>
 #include <tuple>
+#include <unordered_map>
 #include <hyprutils/memory/SharedPtr.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
+#include <hyprutils/os/FileDescriptor.hpp>
+#include <hyprutils/utils/ScopeGuard.hpp>
+#include "./Instrumentation.hpp"
 #include "./Listener.hpp"
 
 namespace Hyprutils {
     namespace Signal {
+        /* bookkeeping shared by all signals, independent of the listener type */
         class CSignalBase {
+          public:
+            CSignalBase() = default;
+            ~CSignalBase();
+
+            /*
+                A listener belongs to one signal, so signals can't be copied.
+                Moving takes all listeners along, including ones that are being emitted to.
+            */
+            CSignalBase(const CSignalBase&) = delete;
+            CSignalBase(CSignalBase&& other) noexcept;
+            CSignalBase& operator=(const CSignalBase&) = delete;
+            CSignalBase& operator=(CSignalBase&& other) noexcept;
+
+            /* the name this signal is recorded under, see Instrumentation.hpp. Does nothing without instrumentation. */
+            void setName(std::string_view name) {
+                if constexpr (Impl_::INSTRUMENTED)
+                    m_pRecord = Impl_::signalRecord(name);
+            }
+
           protected:
-            CHyprSignalListener                                             registerListenerInternal(std::function<void(void*)> handler);
-            void                                                            registerStaticListenerInternal(std::function<void(void*)> handler);
-            void                                                            emitInternal(void* args);
+            /* how handlers take an argument of the signal: small values by value, the rest by const ref */
+            template <typename T>
+            using RefArg = std::conditional_t<std::is_reference_v<T> || std::is_arithmetic_v<T>, T, const T&>;
+
+            /* the owner of a member listener, its type is only known to the thunk of CSignalT */
+            struct SOpaqueOwner;
+
+            /* a pointer to member function, stored as bytes */
+            struct SMemberMethod {
+                alignas(void*) unsigned char bytes[2 * sizeof(void*)];
+            };
+
+            /* a listener calling a method of an owner it holds weakly, stored in the signal itself */
+            struct SMemberListener {
+                Memory::CWeakPointer<SOpaqueOwner> owner;
+                /* the typed thunk of CSignalT */
+                void (*thunk)() = nullptr;
+                SMemberMethod method;
+            };
+
+            CHyprSignalListener registerListenerInternal(CHyprSignalListener listener, int32_t priority);
+            void                registerStaticListenerInternal(CHyprSignalListener listener);
+            void                registerMemberListenerInternal(SMemberListener&& listener);
+
+            /* records the listener's calls under where it was created, see Instrumentation.hpp */
+            static void tagListener(CSignalListener* listener, const std::source_location& location) {
+                if constexpr (Impl_::INSTRUMENTED)
+                    listener->m_pRecord = Impl_::listenerRecord(location);
+            }
+
+            /*
+                An emit in progress, see Signal.cpp.
+                If the signal dies during one, its listeners move to the outermost frame.
+            */
+            struct SEmitFrame {
+                SEmitFrame(CSignalBase* signal_);
+                ~SEmitFrame();
+
+                SEmitFrame* prev = nullptr;
+                /* null once the signal is gone */
+                CSignalBase*                                                     signal    = nullptr;
+                SListenerList*                                                   listeners = nullptr;
+                std::vector<SMemberListener>*                                    members   = nullptr;
+                std::vector<Hyprutils::Memory::CSharedPointer<CSignalListener>>* statics   = nullptr;
+
+                /* the listeners of a signal destroyed mid-emit, only used by the outermost frame */
+                SListenerList                                                   orphanedListeners;
+                std::vector<SMemberListener>                                    orphanedMembers;
+                std::vector<Hyprutils::Memory::CSharedPointer<CSignalListener>> orphanedStatics;
+            };
+
+            /*
+                Calls fn with every listener, then memberFn with every member listener and its owner, then fn with the static ones.
+                If fn returns a bool, true means the event was consumed: nothing is called after that, and emitInternal returns true.
+            */
+            template <typename Fn, typename MemberFn>
+            bool emitInternal(Fn&& fn, MemberFn&& memberFn) {
+                if (!m_listeners.head && m_vMemberListeners.empty() && m_vStaticListeners.empty())
+                    return false;
+
+                if (m_bMembersExpired && !m_pEmitFrame)
+                    eraseExpiredMembers();
+
+                if constexpr (Impl_::INSTRUMENTED) {
+                    if (!m_pRecord)
+                        m_pRecord = Impl_::signalRecord("(unnamed)");
+                }
+
+                // the record outlives the signal, which may not be the case for the emit
+                const auto RECORD  = m_pRecord;
+                size_t     fanOut  = 0;
+                uint64_t   totalNs = 0;
 
-            std::vector<Hyprutils::Memory::CWeakPointer<CSignalListener>>   m_vListeners;
+                const auto timed = [&](Impl_::SListenerRecord* listener, auto&& invoke) {
+                    if constexpr (!Impl_::INSTRUMENTED)
+                        invoke();
+                    else {
+                        const auto BEGIN = Impl_::now();
+                        invoke();
+                        const auto NS = Impl_::now() - BEGIN;
+
+                        Impl_::recordCall(listener, NS);
+                        fanOut++;
+                        totalNs += NS;
+                    }
+                };
+
+                bool       consumed = false;
+                const auto dispatch = [&](CSignalListener* listener) {
+                    if constexpr (std::is_same_v<std::invoke_result_t<Fn&, CSignalListener*>, bool>)
+                        consumed = fn(listener);
+                    else
+                        fn(listener);
+                };
+
+                const auto call       = [&](CSignalListener* listener) { timed(listener->m_pRecord, [&] { dispatch(listener); }); };
+                const auto callMember = [&](const SMemberListener& listener, void* owner) { timed(nullptr, [&] { memberFn(listener, owner); }); };
+
+                SEmitFrame     frame(this);
+
+                // listeners added from here on have a higher generation and are not called
+                const uint64_t GENERATION = m_listeners.generation;
+                const size_t   MEMBERS    = m_vMemberListeners.size();
+                const size_t   STATICS    = m_vStaticListeners.size();
+
+                auto           current = firstAlive(m_listeners.head, GENERATION);
+                while (current && !consumed) {
+                    call(current.get());
+                    // the ref keeps current linked, let go of it only once we hold the next one
+                    current = firstAlive(current->m_pNext, GENERATION);
+                }
+
+                // the bounds are checked again, a handler may have assigned to the signal
+                for (size_t i = 0; i < MEMBERS && i < frame.members->size() && !consumed; ++i) {
+                    auto& member = (*frame.members)[i];
+                    if (member.owner.expired()) {
+                        // erased once no emit is going on, indices have to stay put until then
+                        if (member.owner.impl_ && frame.signal)
+                            frame.signal->m_bMembersExpired = true;
+                        member.owner.reset();
+                        continue;
+                    }
+
+                    // the vector may grow during the call, memberFn copies what it needs first
+                    callMember(member, member.owner.impl_->getData());
+                }
+
+                for (size_t i = 0; i < STATICS && i < frame.statics->size() && !consumed; ++i) {
+                    call((*frame.statics)[i].get());
+                }
+
+                if constexpr (Impl_::INSTRUMENTED)
+                    Impl_::recordEmit(RECORD, fanOut, totalNs);
+
+                return consumed;
+            }
+
+            bool emitting() const {
+                return m_pEmitFrame;
+            }
+
+            SListenerList                                                   m_listeners;
+            std::vector<SMemberListener>                                    m_vMemberListeners;
             std::vector<Hyprutils::Memory::CSharedPointer<CSignalListener>> m_vStaticListeners;
+
+          private:
+            void eraseExpiredMembers();
+            /* drops all listeners, emits in progress finish with the ones they started with */
+            void orphanListeners();
+            /* takes the listeners and the emits in progress of other, which has to be empty */
+            void adoptListeners(CSignalBase& other);
+
+            /* a strong ref to the first listener from l on that is not being destroyed, and not newer than generation */
+            static CHyprSignalListener firstAlive(CSignalListener* l, uint64_t generation) {
+                for (; l; l = l->m_pNext) {
+                    // with priorities, newer listeners may sit anywhere in the list
+                    if (l->m_generation > generation)
+                        continue;
+
+                    if (auto self = l->sharedSelf())
+                        return self;
+                }
+
+                return nullptr;
+            }
+
+            /* the innermost emit in progress */
+            SEmitFrame* m_pEmitFrame = nullptr;
+            /* an emit found a member listener whose owner is gone */
+            bool m_bMembersExpired = false;
+            /* null without instrumentation, the layout doesn't depend on it */
+            Impl_::SSignalRecord* m_pRecord = nullptr;
         };
 
         template <typename... Args>
         class CSignalT : public CSignalBase {
-            template <typename T>
-            using RefArg = std::conditional_t<std::is_reference_v<T> || std::is_arithmetic_v<T>, T, const T&>;
+            using CListener = CSignalListenerT<RefArg<Args>...>;
+
+            using MemberThunk = void (*)(void* owner, SMemberMethod method, RefArg<Args>... args);
+
+            template <typename Owner, typename Method>
+            static void memberThunk(void* owner, SMemberMethod storage, RefArg<Args>... args) {
+                Method method;
+                std::memcpy(&method, storage.bytes, sizeof(Method));
+
+                if constexpr (std::is_invocable_v<Method, Owner*, RefArg<Args>...>)
+                    std::invoke(method, Memory::sc<Owner*>(owner), args...);
+                else
+                    std::invoke(method, Memory::sc<Owner*>(owner));
+            }
 
           public:
             void emit(RefArg<Args>... args) {
-                if constexpr (sizeof...(Args) == 0)
-                    emitInternal(nullptr);
-                else {
-                    auto argsTuple = std::tuple<RefArg<Args>...>(args...);
-
-                    if constexpr (sizeof...(Args) == 1)
-                        // NOLINTNEXTLINE: const is reapplied by handler invocation if required
-                        emitInternal(Memory::cc<void*>(Memory::sc<const void*>(&std::get<0>(argsTuple))));
-                    else
-                        emitInternal(&argsTuple);
-                }
+                // every listener of this signal is a CListener, so this is a single indirect call each
+                emitInternal([&](CSignalListener* listener) { Memory::sc<CListener*>(listener)->call(args...); },
+                             [&](const SMemberListener& listener, void* owner) { Memory::rc<MemberThunk>(listener.thunk)(owner, listener.method, args...); });
+            }
+
+            /*
+                Calls method on owner with every emit, for as long as owner is alive.
+                The listener lives in the signal: there's no CHyprSignalListener to keep around, and nothing is allocated for it.
+                The method may take the arguments of the signal, or none.
+            */
+            template <typename Owner, typename Method>
+                requires(std::is_member_function_pointer_v<Method> &&
+                         (std::is_invocable_v<Method, Owner*, RefArg<Args>...> || (sizeof...(Args) != 0 && std::is_invocable_v<Method, Owner*>)))
+            void listen(const Memory::CWeakPointer<Owner>& owner, Method method) {
+                static_assert(sizeof(Method) <= sizeof(SMemberMethod), "pointer to member function too big, is the owner virtually inherited?");
+
+                if (owner.expired())
+                    return;
+
+                SMemberListener listener;
+                listener.owner = Memory::CWeakPointer<SOpaqueOwner>(owner.impl_);
+                listener.thunk = Memory::rc<void (*)()>(&memberThunk<Owner, Method>);
+                std::memcpy(listener.method.bytes, &method, sizeof(Method));
+                registerMemberListenerInternal(std::move(listener));
             }
 
-            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(std::function<void(RefArg<Args>...)> handler) {
-                return registerListenerInternal(mkHandler(handler));
+            /* listeners with a higher priority are called first, ones with the same in the order they were added */
+            template <typename F>
+                requires std::is_invocable_v<std::decay_t<F>&, RefArg<Args>...>
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(F&& handler, int32_t priority = 0,
+                                                                                                      std::source_location location = std::source_location::current()) {
+                auto listener = Memory::makeShared<CListener>(std::forward<F>(handler));
+                tagListener(listener.get(), location);
+                return registerListenerInternal(std::move(listener), priority);
             }
 
-            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(std::function<void()> handler)
-                requires(sizeof...(Args) != 0)
-            {
-                return listen([handler](RefArg<Args>... args) { handler(); });
+            template <typename F>
+                requires(sizeof...(Args) != 0 && std::is_invocable_v<std::decay_t<F>&>)
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(F&& handler, int32_t priority = 0,
+                                                                                                      std::source_location location = std::source_location::current()) {
+                return listen([handler = std::forward<F>(handler)](RefArg<Args>... args) mutable { handler(); }, priority, location);
             }
 
             template <typename... OtherArgs>
@@ -70,14 +297,18 @@ namespace Hyprutils {
             }
 
             // this is for static listeners. They die with this signal.
-            void listenStatic(std::function<void(RefArg<Args>...)> handler) {
-                registerStaticListenerInternal(mkHandler(handler));
+            template <typename F>
+                requires std::is_invocable_v<std::decay_t<F>&, RefArg<Args>...>
+            void listenStatic(F&& handler, std::source_location location = std::source_location::current()) {
+                auto listener = Memory::makeShared<CListener>(std::forward<F>(handler));
+                tagListener(listener.get(), location);
+                registerStaticListenerInternal(std::move(listener));
             }
 
-            void listenStatic(std::function<void()> handler)
-                requires(sizeof...(Args) != 0)
-            {
-                return listenStatic([handler](RefArg<Args>... args) { handler(); });
+            template <typename F>
+                requires(sizeof...(Args) != 0 && std::is_invocable_v<std::decay_t<F>&>)
+            void listenStatic(F&& handler, std::source_location location = std::source_location::current()) {
+                return listenStatic([handler = std::forward<F>(handler)](RefArg<Args>... args) mutable { handler(); }, location);
             }
 
             // Deprecated: use listenStatic()
@@ -87,18 +318,301 @@ namespace Hyprutils {
                     handler(owner, mkAny(args...));
                 });
             }
+        };
+
+        /*
+            A signal for events that one listener should handle, e.g. input routed through a chain of handlers.
+            Handlers return true when they consumed the event, which ends the emit: the listeners after them aren't called.
+            Listeners are called by priority, highest first, kept sorted when they are added.
+        */
+        template <typename... Args>
+        class CConsumableSignalT : public CSignalBase {
+            using CListener = CConsumableListenerT<RefArg<Args>...>;
+
+          public:
+            /* true if a listener consumed the event */
+            bool emit(RefArg<Args>... args) {
+                return emitInternal([&](CSignalListener* listener) { return Memory::sc<CListener*>(listener)->call(args...); }, [](const SMemberListener&, void*) {});
+            }
+
+            template <typename F>
+                requires std::is_invocable_r_v<bool, std::decay_t<F>&, RefArg<Args>...>
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(F&& handler, int32_t priority = 0,
+                                                                                                      std::source_location location = std::source_location::current()) {
+                auto listener = Memory::makeShared<CListener>(std::forward<F>(handler));
+                tagListener(listener.get(), location);
+                return registerListenerInternal(std::move(listener), priority);
+            }
+
+            template <typename F>
+                requires(sizeof...(Args) != 0 && std::is_invocable_r_v<bool, std::decay_t<F>&>)
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(F&& handler, int32_t priority = 0,
+                                                                                                      std::source_location location = std::source_location::current()) {
+                return listen([handler = std::forward<F>(handler)](RefArg<Args>... args) mutable { return handler(); }, priority, location);
+            }
+        };
+
+        enum eDeferPolicy : uint8_t {
+            DEFER_KEEP_ALL = 0, /* dispatch every event, in order */
+            DEFER_KEEP_LAST,    /* dispatch only the last event */
+            DEFER_MERGE,        /* fold all events into one with a reducer, or keep the last without one */
+        };
+
+        /*
+            A signal that queues its events and dispatches them on flush(), e.g. once per frame.
+            Listeners are the same as with CSignalT, they just get called later.
+
+            Arguments are stored by value until the flush, references included.
+            Events emitted during a flush are dispatched by the next one.
+        */
+        template <typename... Args>
+        class CDeferredSignalT : public CSignalT<Args...> {
+          public:
+            using Event = std::tuple<std::decay_t<Args>...>;
+            /* folds an incoming event into the pending one */
+            using Reducer = Utils::CFunction<void(Event& pending, Event&& incoming)>;
+
+            CDeferredSignalT(eDeferPolicy policy = DEFER_KEEP_ALL) : m_policy(policy) {
+                ;
+            }
+
+            CDeferredSignalT(Reducer reducer) : m_policy(DEFER_MERGE), m_reducer(std::move(reducer)) {
+                ;
+            }
+
+            ~CDeferredSignalT() {
+                if (m_pFlushAlive)
+                    *m_pFlushAlive = false;
+            }
+
+            CDeferredSignalT(const CDeferredSignalT&)            = delete;
+            CDeferredSignalT& operator=(const CDeferredSignalT&) = delete;
+
+            /* queues an event, see eDeferPolicy */
+            template <typename... EmitArgs>
+            void emit(EmitArgs&&... args) {
+                if (m_queue.empty() || m_policy == DEFER_KEEP_ALL)
+                    m_queue.emplace_back(std::forward<EmitArgs>(args)...);
+                else if (m_policy == DEFER_KEEP_LAST || !m_reducer)
+                    m_queue.back() = Event(std::forward<EmitArgs>(args)...);
+                else
+                    m_reducer(m_queue.back(), Event(std::forward<EmitArgs>(args)...));
+            }
+
+            /* dispatches the queued events. Does nothing if called from within a flush. */
+            void flush() {
+                if (m_pFlushAlive || m_queue.empty())
+                    return;
+
+                bool alive    = true;
+                m_pFlushAlive = &alive;
+
+                // also if a handler throws, unless it destroyed the signal
+                Utils::CScopeGuard done([this, &alive] {
+                    if (alive)
+                        m_pFlushAlive = nullptr;
+                });
+
+                // swap with the spare vector, so the next frame's events go into allocated storage
+                auto events = std::move(m_queue);
+                m_queue     = std::move(m_spare);
+
+                for (auto& event : events) {
+                    std::apply([this](auto&... args) { CSignalT<Args...>::emit(args...); }, event);
+
+                    // a handler destroyed the signal
+                    if (!alive)
+                        return;
+                }
+
+                events.clear();
+                m_spare = std::move(events);
+            }
+
+            /* drops the queued events */
+            void discard() {
+                m_queue.clear();
+            }
+
+            size_t pending() const {
+                return m_queue.size();
+            }
 
           private:
-            std::function<void(void*)> mkHandler(std::function<void(RefArg<Args>...)> handler) {
-                return [handler](void* args) {
-                    if constexpr (sizeof...(Args) == 0)
-                        handler();
-                    else if constexpr (sizeof...(Args) == 1)
-                        handler(*Memory::sc<std::remove_reference_t<std::tuple_element_t<0, std::tuple<RefArg<Args>...>>>*>(args));
-                    else
-                        std::apply(handler, *Memory::sc<std::tuple<RefArg<Args>...>*>(args));
-                };
+            eDeferPolicy       m_policy = DEFER_KEEP_ALL;
+            Reducer            m_reducer;
+            std::vector<Event> m_queue;
+            std::vector<Event> m_spare;
+            /* set while flushing, cleared if the signal dies meanwhile */
+            bool* m_pFlushAlive = nullptr;
+        };
+
+        /*
+            A lock-free queue with any amount of producer threads and a single consumer, the owner.
+            Pushing never blocks: it's an atomic exchange, and a write to an eventfd if the owner isn't woken up yet.
+        */
+        class CCrossThreadQueue {
+          public:
+            struct SNode {
+                std::atomic<SNode*> next = nullptr;
+            };
+
+            /* throws std::system_error if the eventfd can't be created */
+            CCrossThreadQueue();
+
+            CCrossThreadQueue(const CCrossThreadQueue&)            = delete;
+            CCrossThreadQueue& operator=(const CCrossThreadQueue&) = delete;
+
+            /* from any thread */
+            void push(SNode* node);
+
+            /* owner only. Null if empty, or if the next node is still being pushed, its producer wakes the owner again. */
+            SNode* pop();
+
+            /* owner only. Resets the eventfd, call before popping. */
+            void acknowledge();
+
+            /* readable when there are nodes to pop, or spuriously when they were popped before their wakeup arrived */
+            const OS::CFileDescriptor& getFD() const;
+
+          private:
+            void                            link(SNode* node);
+
+            alignas(64) std::atomic<SNode*> m_head;
+            std::atomic<bool>               m_wakePending = false;
+            alignas(64) SNode*              m_tail;
+            SNode                           m_stub;
+            OS::CFileDescriptor             m_eventFD;
+        };
+
+        /*
+            A signal that may be emitted from any thread with emitFromAnyThread().
+            The arguments are stored by value and the listeners are called on the owner's thread,
+            when its event loop sees getFD() readable and calls dispatchPending().
+            Everything else, including emit(), stays owner thread only, and the signal must outlive the producers.
+        */
+        template <typename... Args>
+        class CCrossThreadSignalT : public CSignalT<Args...> {
+          public:
+            using Event = std::tuple<std::decay_t<Args>...>;
+
+            CCrossThreadSignalT() = default;
+
+            ~CCrossThreadSignalT() {
+                if (m_pDispatchAlive)
+                    *m_pDispatchAlive = false;
+
+                while (auto node = m_queue.pop()) {
+                    delete Memory::sc<SQueuedEvent*>(node);
+                }
+            }
+
+            CCrossThreadSignalT(const CCrossThreadSignalT&)            = delete;
+            CCrossThreadSignalT& operator=(const CCrossThreadSignalT&) = delete;
+
+            /* thread-safe, never blocks */
+            template <typename... EmitArgs>
+            void emitFromAnyThread(EmitArgs&&... args) {
+                m_queue.push(new SQueuedEvent(std::forward<EmitArgs>(args)...));
+            }
+
+            /* calls the listeners with everything queued so far. Does nothing if called from within a dispatch. */
+            void dispatchPending() {
+                if (m_pDispatchAlive)
+                    return;
+
+                bool alive       = true;
+                m_pDispatchAlive = &alive;
+
+                // see CDeferredSignalT::flush
+                Utils::CScopeGuard done([this, &alive] {
+                    if (alive)
+                        m_pDispatchAlive = nullptr;
+                });
+
+                m_queue.acknowledge();
+
+                while (auto node = m_queue.pop()) {
+                    std::unique_ptr<SQueuedEvent> queued(Memory::sc<SQueuedEvent*>(node));
+                    std::apply([this](auto&... args) { CSignalT<Args...>::emit(args...); }, queued->event);
+
+                    // a handler destroyed the signal
+                    if (!alive)
+                        return;
+                }
+            }
+
+            /* for the owner's event loop, readable when dispatchPending() has something to do */
+            const OS::CFileDescriptor& getFD() const {
+                return m_queue.getFD();
+            }
+
+          private:
+            struct SQueuedEvent : CCrossThreadQueue::SNode {
+                template <typename... EmitArgs>
+                SQueuedEvent(EmitArgs&&... args) : event(std::forward<EmitArgs>(args)...) {
+                    ;
+                }
+
+                Event event;
+            };
+
+            CCrossThreadQueue m_queue;
+            /* set while dispatching, cleared if the signal dies meanwhile */
+            bool* m_pDispatchAlive = nullptr;
+        };
+
+        /*
+            A signal whose listeners subscribe to a key, e.g. the id of a surface.
+            emit(key, ...) only calls the listeners of that key, found through a hash map,
+            instead of every listener filtering on the key by itself.
+            Listeners behave like the ones of CSignalT: they are unregistered when the CHyprSignalListener dies.
+        */
+        template <typename Key, typename... Args>
+        class CKeyedSignalT {
+          public:
+            template <typename F>
+            [[nodiscard("Listener is unregistered when the ptr is lost")]] CHyprSignalListener listen(const Key& key, F&& handler,
+                                                                                                      std::source_location location = std::source_location::current()) {
+                if (m_buckets.size() >= m_sweepAt)
+                    sweep();
+
+                return m_buckets[key].listen(std::forward<F>(handler), 0, location);
+            }
+
+            template <typename... EmitArgs>
+            void emit(const Key& key, EmitArgs&&... args) {
+                const auto IT = m_buckets.find(key);
+                if (IT == m_buckets.end())
+                    return;
+
+                // nodes are stable, handlers may listen to other keys meanwhile
+                IT->second.emit(std::forward<EmitArgs>(args)...);
+            }
+
+            bool hasListeners(const Key& key) const {
+                const auto IT = m_buckets.find(key);
+                return IT != m_buckets.end() && !IT->second.idle();
+            }
+
+          private:
+            class CBucket : public CSignalT<Args...> {
+              public:
+                /* no live listeners and no emit going on */
+                bool idle() const {
+                    return !this->emitting() && !this->m_listeners.head && this->m_vMemberListeners.empty();
+                }
+            };
+
+            /* drops the buckets of keys nobody listens to anymore */
+            void sweep() {
+                std::erase_if(m_buckets, [](const auto& bucket) { return bucket.second.idle(); });
+                m_sweepAt = std::max<size_t>(16, m_buckets.size() * 2);
             }
+
+            std::unordered_map<Key, CBucket> m_buckets;
+            /* amount of buckets at which the next listen() sweeps */
+            size_t m_sweepAt = 16;
         };
 
         // compat. Deprecated.
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../memory/Casts.hpp"
+
+/*
+    Move-only replacements for std::function.
+
+    CInplaceFunction<R(Args...), N> stores its callable in an inline buffer of N bytes and never allocates.
+    A callable that doesn't fit is a compile error.
+    CFunction<R(Args...)> has a 48 byte inline buffer and puts bigger callables on the heap.
+
+    Being move-only, they can hold move-only callables, and they never copy captures behind your back.
+    There is no RTTI involved, calling goes through a single function pointer.
+    Calling an empty one is undefined behavior, check it first.
+*/
+
+namespace Hyprutils::Utils {
+    namespace Function_ {
+        template <typename T>
+        inline constexpr bool isStdFunction = false;
+
+        template <typename Sig>
+        inline constexpr bool isStdFunction<std::function<Sig>> = true;
+
+        template <typename Sig, size_t N, bool HEAP>
+        class CFunctionBase;
+
+        template <typename R, typename... Args, size_t N, bool HEAP>
+        class CFunctionBase<R(Args...), N, HEAP> {
+          public:
+            CFunctionBase() noexcept = default;
+
+            CFunctionBase(std::nullptr_t) noexcept {
+                ;
+            }
+
+            template <typename F>
+                requires(!std::is_same_v<std::remove_cvref_t<F>, CFunctionBase> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+            CFunctionBase(F&& fn) {
+                using D = std::decay_t<F>;
+
+                // null function pointers and empty std::functions make an empty function.
+                // Other callables are never empty, even if they convert to bool.
+                if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D>) {
+                    const D PTR = fn;
+                    if (PTR == nullptr)
+                        return;
+                } else if constexpr (isStdFunction<D>) {
+                    if (!fn)
+                        return;
+                }
+
+                if constexpr (inlineable<D>()) {
+                    ::new (m_storage) D(std::forward<F>(fn));
+                    m_invoke = &invokeInline<D>;
+                    m_manage = &manageInline<D>;
+                } else {
+                    static_assert(HEAP, "callable doesn't fit the inline buffer of CInplaceFunction");
+                    ::new (m_storage) D*(new D(std::forward<F>(fn)));
+                    m_invoke = &invokeHeap<D>;
+                    m_manage = &manageHeap<D>;
+                }
+            }
+
+            CFunctionBase(CFunctionBase&& other) noexcept {
+                moveFrom(other);
+            }
+
+            CFunctionBase& operator=(CFunctionBase&& other) noexcept {
+                if (this != &other) {
+                    reset();
+                    moveFrom(other);
+                }
+                return *this;
+            }
+
+            CFunctionBase& operator=(std::nullptr_t) noexcept {
+                reset();
+                return *this;
+            }
+
+            template <typename F>
+                requires(!std::is_same_v<std::remove_cvref_t<F>, CFunctionBase> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+            CFunctionBase& operator=(F&& fn) {
+                return *this = CFunctionBase(std::forward<F>(fn));
+            }
+
+            CFunctionBase(const CFunctionBase&)            = delete;
+            CFunctionBase& operator=(const CFunctionBase&) = delete;
+
+            ~CFunctionBase() {
+                reset();
+            }
+
+            R operator()(Args... args) const {
+                return m_invoke(m_storage, std::forward<Args>(args)...);
+            }
+
+            explicit operator bool() const noexcept {
+                return m_invoke;
+            }
+
+            bool operator==(std::nullptr_t) const noexcept {
+                return !m_invoke;
+            }
+
+            void swap(CFunctionBase& other) noexcept {
+                CFunctionBase tmp = std::move(other);
+                other             = std::move(*this);
+                *this             = std::move(tmp);
+            }
+
+            void reset() noexcept {
+                if (m_manage)
+                    m_manage(m_storage, nullptr);
+
+                m_invoke = nullptr;
+                m_manage = nullptr;
+            }
+
+          private:
+            using InvokeFn = R (*)(void*, Args&&...);
+            /* moves the callable from src to dst and destroys src. Destroys dst if src is null. */
+            using ManageFn = void (*)(void* dst, void* src) noexcept;
+
+            template <typename D>
+            static constexpr bool inlineable() {
+                return sizeof(D) <= N && alignof(D) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<D>;
+            }
+
+            template <typename D>
+            static R invokeInline(void* storage, Args&&... args) {
+                if constexpr (std::is_void_v<R>)
+                    std::invoke(*std::launder(Memory::rc<D*>(storage)), std::forward<Args>(args)...);
+                else
+                    return std::invoke(*std::launder(Memory::rc<D*>(storage)), std::forward<Args>(args)...);
+            }
+
+            template <typename D>
+            static void manageInline(void* dst, void* src) noexcept {
+                if (!src) {
+                    std::destroy_at(std::launder(Memory::rc<D*>(dst)));
+                    return;
+                }
+
+                auto from = std::launder(Memory::rc<D*>(src));
+                ::new (dst) D(std::move(*from));
+                std::destroy_at(from);
+            }
+
+            template <typename D>
+            static R invokeHeap(void* storage, Args&&... args) {
+                if constexpr (std::is_void_v<R>)
+                    std::invoke(**Memory::rc<D**>(storage), std::forward<Args>(args)...);
+                else
+                    return std::invoke(**Memory::rc<D**>(storage), std::forward<Args>(args)...);
+            }
+
+            template <typename D>
+            static void manageHeap(void* dst, void* src) noexcept {
+                if (!src)
+                    delete *Memory::rc<D**>(dst);
+                else
+                    ::new (dst) D*(*Memory::rc<D**>(src));
+            }
+
+            void moveFrom(CFunctionBase& other) noexcept {
+                if (!other.m_manage)
+                    return;
+
+                other.m_manage(m_storage, other.m_storage);
+                m_invoke       = other.m_invoke;
+                m_manage       = other.m_manage;
+                other.m_invoke = nullptr;
+                other.m_manage = nullptr;
+            }
+
+            static_assert(N >= sizeof(void*), "the inline buffer has to fit at least a pointer");
+
+            InvokeFn m_invoke = nullptr;
+            ManageFn m_manage = nullptr;
+
+            alignas(std::max_align_t) mutable unsigned char m_storage[N];
+        };
+    }
+
+    /* the inline buffer of CFunction, together with the two function pointers, it fills a cache line */
+    constexpr size_t FUNCTION_INLINE_SIZE = 48;
+
+    template <typename Sig>
+    using CFunction = Function_::CFunctionBase<Sig, FUNCTION_INLINE_SIZE, true>;
+
+    template <typename Sig, size_t N = FUNCTION_INLINE_SIZE>
+    using CInplaceFunction = Function_::CFunctionBase<Sig, N, false>;
+}
@@ -1,17 +1,17 @@
 #pragma once
 
-#include <functional>
+#include "Function.hpp"
 
 namespace Hyprutils {
     namespace Utils {
         // calls a function when it goes out of scope
         class CScopeGuard {
           public:
-            CScopeGuard(const std::function<void()>& fn_);
+            CScopeGuard(CFunction<void()> fn_);
             ~CScopeGuard();
 
           private:
-            std::function<void()> fn;
+            CFunction<void()> fn;
         };
     };
 };
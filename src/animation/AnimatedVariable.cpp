@@ -67,7 +67,11 @@ const std::string& CBaseAnimatedVariable::getStyle() const {
 }
 
 float CBaseAnimatedVariable::getPercent() const {
-    const auto DURATIONPASSED = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - animationBegin).count();
+    return getPercent(std::chrono::steady_clock::now());
+}
+
+float CBaseAnimatedVariable::getPercent(std::chrono::steady_clock::time_point now) const {
+    const auto DURATIONPASSED = std::chrono::duration_cast<std::chrono::milliseconds>(now - animationBegin).count();
 
     if (m_pConfig && m_pConfig->pValues)
         return std::clamp((DURATIONPASSED / 100.f) / m_pConfig->pValues->internalSpeed, 0.f, 1.f);
@@ -134,7 +138,7 @@ void CBaseAnimatedVariable::onAnimationEnd() {
 
         cb(m_pSelf);
         if (!m_bRemoveEndAfterRan && /* callback did not set a new one by itself */ !m_fEndCallback)
-            m_fEndCallback = cb; // restore
+            m_fEndCallback = std::move(cb); // restore
     }
 }
 
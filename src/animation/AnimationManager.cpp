@@ -60,20 +60,94 @@ void CAnimationManager::tickDone() {
     rotateActive();
 }
 
-void CAnimationManager::rotateActive() {
-    std::vector<CWeakPointer<CBaseAnimatedVariable>> active;
-    active.reserve(m_vActiveAnimatedVariables.size()); // avoid reallocations
+void CAnimationManager::setTickHandler(int type, TickHandler handler) {
+    const auto IT = std::ranges::find(m_vTickers, type, &STypeTicker::type);
+    if (IT != m_vTickers.end()) {
+        IT->handler = std::move(handler);
+        return;
+    }
+
+    m_vTickers.emplace_back(STypeTicker{.type = type, .handler = std::move(handler), .steps = {}});
+}
+
+void CAnimationManager::tick(std::chrono::steady_clock::time_point now) {
+    for (auto& ticker : m_vTickers) {
+        ticker.steps.clear();
+    }
+
+    // taken out while callbacks run, one of them could tick again
+    auto ticked = std::move(m_vTicked);
+
+    // neighbours mostly share a type and a config, no need to look those up for each
+    STypeTicker*                    ticker  = nullptr;
+    const SAnimationPropertyConfig* config  = nullptr;
+    bool                            enabled = false;
+    CBezierCurve*                   bezier  = nullptr;
+
     for (auto const& av : m_vActiveAnimatedVariables) {
-        if (!av)
+        if (!av || !av->ok() || !av->isBeingAnimated())
             continue;
 
-        if (av->ok() && av->isBeingAnimated())
-            active.emplace_back(av);
-        else
-            av->m_bIsConnectedToActive = false;
+        if (!ticker || ticker->type != av->m_Type) {
+            const auto IT = std::ranges::find(m_vTickers, av->m_Type, &STypeTicker::type);
+            ticker        = IT == m_vTickers.end() ? nullptr : &*IT;
+        }
+
+        if (!ticker || !ticker->handler)
+            continue;
+
+        if (config != av->m_pConfig.get()) {
+            config  = av->m_pConfig.get();
+            enabled = av->enabled();
+            bezier  = getBezier(av->getBezierName()).get();
+        }
+
+        const auto SPENT = av->getPercent(now);
+        const bool OVER  = SPENT >= 1.f || !enabled;
+        const auto CURVE = OVER ? 1.f : bezier->getYForPoint(SPENT);
+
+        ticker->steps.emplace_back(STickStep{.var = av.get(), .curve = CURVE});
+        ticked.emplace_back(STicked{.var = av, .begin = av->animationBegin, .over = OVER});
+    }
+
+    // the numeric pass, no callbacks in here
+    for (auto& t : m_vTickers) {
+        if (!t.steps.empty())
+            t.handler(t.steps);
+    }
+
+    for (auto const& t : ticked) {
+        if (t.var)
+            t.var->onUpdate();
     }
 
-    m_vActiveAnimatedVariables = std::move(active);
+    for (auto const& t : ticked) {
+        // values are at their goal already. Skip those a callback has restarted, the next tick has them.
+        if (!t.over || !t.var || !t.var->isBeingAnimated() || t.var->animationBegin != t.begin)
+            continue;
+
+        t.var->onAnimationEnd();
+    }
+
+    // no weak refs held until the next tick, only the storage
+    ticked.clear();
+    m_vTicked = std::move(ticked);
+
+    tickDone();
+}
+
+void CAnimationManager::rotateActive() {
+    // in place, no weak refs are taken or dropped for the ones that stay
+    std::erase_if(m_vActiveAnimatedVariables, [](const auto& av) {
+        if (!av)
+            return true;
+
+        if (av->ok() && av->isBeingAnimated())
+            return false;
+
+        av->m_bIsConnectedToActive = false;
+        return true;
+    });
 }
 
 bool CAnimationManager::bezierExists(const std::string& bezier) {
@@ -1,8 +1,16 @@
 #include <hyprutils/animation/BezierCurve.hpp>
 #include <hyprutils/memory/Casts.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+
+#ifdef __SSE2__
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
 
 using namespace Hyprutils::Animation;
 using namespace Hyprutils::Math;
@@ -16,6 +24,36 @@ void CBezierCurve::setup(const std::array<Vector2D, 2>& pVec) {
     });
 }
 
+/* the point of the curve at x, t found by bisection to about 1e-12. Picks one of them if x goes back and forth. */
+static double exactYForX(const std::vector<Vector2D>& p, double x) {
+    const auto at = [](double a, double b, double c, double d, double t) {
+        const double U = 1 - t;
+        return (U * U * U * a) + (3 * t * U * U * b) + (3 * t * t * U * c) + (t * t * t * d);
+    };
+
+    double lo = 0;
+    double hi = 1;
+
+    for (int i = 0; i < 40; ++i) {
+        const double T = (lo + hi) / 2;
+
+        if (at(p[0].x, p[1].x, p[2].x, p[3].x, T) < x)
+            lo = T;
+        else
+            hi = T;
+    }
+
+    return at(p[0].y, p[1].y, p[2].y, p[3].y, (lo + hi) / 2);
+}
+
+/* cubic hermite between two baked points, S from 0 to 1 over the cell */
+static float hermite(const float* b, float s) {
+    const float S2 = s * s;
+    const float S3 = S2 * s;
+
+    return (((2 * S3) - (3 * S2) + 1) * b[0]) + ((S3 - (2 * S2) + s) * b[1]) + (((3 * S2) - (2 * S3)) * b[2]) + ((S3 - S2) * b[3]);
+}
+
 void CBezierCurve::setup4(const std::array<Vector2D, 4>& pVec) {
     // Avoid reallocations by reserving enough memory upfront
     m_vPoints.resize(4);
@@ -26,14 +64,47 @@ void CBezierCurve::setup4(const std::array<Vector2D, 4>& pVec) {
         pVec[3],
     };
 
-    // Pre-bake curve
-    //
-    // We start baking at t=(i+1)/n not at t=0
-    // That means the first baked x can be > 0 if curve itself starts at x>0
-    for (int i = 0; i < BAKEDPOINTS; ++i) {
-        // When i=0 -> t=1/255
-        const float t     = (i + 1) * INVBAKEDPOINTS;
-        m_aPointsBaked[i] = Vector2D(getXForT(t), getYForT(t));
+    // per half, y at a distance of 0.5 * w^4 from its end
+    const auto yAt = [this](int half, double w) {
+        w              = std::clamp(w, 0.0, 1.0);
+        const double U = 0.5 * w * w * w * w;
+        return exactYForX(m_vPoints, half == 0 ? U : 1 - U);
+    };
+
+    // Pre-bake y and its slope over a cell, densest at the ends, where the curve can get vertical
+    for (int half = 0; half < 2; ++half) {
+        for (int i = 0; i <= HALFCELLS; ++i) {
+            const double W     = sc<double>(i) / HALFCELLS;
+            const double DW    = 1e-4 / HALFCELLS;
+            const double LO    = std::max(0.0, W - DW);
+            const double HI    = std::min(1.0, W + DW);
+            const size_t INDEX = 2 * ((half * (HALFCELLS + 1)) + i);
+
+            m_aBaked[INDEX]     = sc<float>(yAt(half, W));
+            m_aBaked[INDEX + 1] = sc<float>((yAt(half, HI) - yAt(half, LO)) / (HI - LO) / HALFCELLS);
+        }
+    }
+
+    // Around a vertical tangent inside (0, 1) the cells are too coarse for a hermite, y goes like a cube root there.
+    // Such cells are solved for t instead. A NaN slope marks them, it makes the hermite of both cells next to it NaN.
+    constexpr double     MAXERROR = 1e-5;
+    std::vector<size_t> poisoned;
+
+    for (int half = 0; half < 2; ++half) {
+        for (int i = 0; i < HALFCELLS; ++i) {
+            const size_t INDEX = 2 * ((half * (HALFCELLS + 1)) + i);
+
+            for (const float S : {0.25f, 0.5f, 0.75f}) {
+                if (!(std::abs(hermite(&m_aBaked[INDEX], S) - yAt(half, (i + S) / HALFCELLS)) <= MAXERROR)) {
+                    poisoned.insert(poisoned.end(), {INDEX + 1, INDEX + 3});
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const auto I : poisoned) {
+        m_aBaked[I] = std::numeric_limits<float>::quiet_NaN();
     }
 }
 
@@ -51,55 +122,99 @@ float CBezierCurve::getYForT(float const& t) const {
     return ((1 - t) * (1 - t) * (1 - t) * m_vPoints[0].y) + (3 * t * (1 - t) * (1 - t) * m_vPoints[1].y) + (3 * t2 * (1 - t) * m_vPoints[2].y) + (t3 * m_vPoints[3].y);
 }
 
-// Todo: this probably can be done better and faster
 float CBezierCurve::getYForPoint(float const& x) const {
-    if (x >= 1.f)
+    // NaN ends up at 1 as well
+    if (!(x < 1.f))
         return 1.f;
     if (x <= 0.f)
         return 0.f;
 
-    int  index = 0;
-    bool below = true;
-    for (int step = (BAKEDPOINTS + 1) / 2; step > 0; step /= 2) {
-        if (below)
-            index += step;
-        else
-            index -= step;
-
-        // Clamp to avoid index walking off
-        if (index < 0)
-            index = 0;
-        else if (index > BAKEDPOINTS - 1)
-            index = BAKEDPOINTS - 1;
+    // the half x is in and how far it is from that half's end
+    const int   HALF = x >= 0.5f;
+    const float U    = HALF ? 1.f - x : x;
 
-        below = m_aPointsBaked[index].x < x;
-    }
-
-    int lowerIndex = index - (!below || index == BAKEDPOINTS - 1);
-
-    // Clamp final indices
-    if (lowerIndex < 0)
-        lowerIndex = 0;
-    else if (lowerIndex > BAKEDPOINTS - 2)
-        lowerIndex = BAKEDPOINTS - 2;
-
-    // In the name of performance I shall make a hack
-    const auto& LOWERPOINT = m_aPointsBaked[lowerIndex];
-    const auto& UPPERPOINT = m_aPointsBaked[lowerIndex + 1];
+    // the cells are uniform in U^(1/4), y is a cubic hermite between the baked points
+    const float  CELL  = std::sqrt(std::sqrt(2.f * U)) * HALFCELLS;
+    const int    INDEX = std::min(sc<int>(CELL), HALFCELLS - 1);
+    const float* B     = &m_aBaked[2 * ((HALF * (HALFCELLS + 1)) + INDEX)];
+    const float  Y     = hermite(B, CELL - sc<float>(INDEX));
 
-    const float dx = (UPPERPOINT.x - LOWERPOINT.x);
-    // If two baked points have almost the same x
-    //  just return the lower one
-    if (dx <= 1e-6f)
-        return LOWERPOINT.y;
+    // the cell is solved for t, see setup4
+    if (std::isnan(Y))
+        return sc<float>(exactYForX(m_vPoints, x));
 
-    const auto PERCINDELTA = (x - LOWERPOINT.x) / dx;
+    return Y;
+}
 
-    // Can sometimes happen for VERY small x
-    if (std::isnan(PERCINDELTA) || std::isinf(PERCINDELTA))
-        return LOWERPOINT.y;
+void CBezierCurve::getYForPoints(std::span<const float> xs, std::span<float> ys) const {
+    const size_t COUNT = std::min(xs.size(), ys.size());
+    size_t       i     = 0;
+
+#ifdef __SSE2__
+    // getYForPoint on four lanes, every operation in the same order to get the same results.
+    // That only holds without contraction into FMAs, see CMakeLists.txt.
+    const auto   select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+
+    const __m128 ZERO     = _mm_setzero_ps();
+    const __m128 ONE      = _mm_set1_ps(1.f);
+    const __m128 TWO      = _mm_set1_ps(2.f);
+    const __m128 THREE    = _mm_set1_ps(3.f);
+    const __m128 MIDDLE   = _mm_set1_ps(0.5f);
+    const __m128 CELLS    = _mm_set1_ps(HALFCELLS);
+    const __m128 LASTCELL = _mm_set1_ps(HALFCELLS - 1);
+
+    for (; i + 4 <= COUNT; i += 4) {
+        const __m128 X = _mm_loadu_ps(&xs[i]);
+
+        // NaN is not less than 1, and _mm_max_ps turns it into 0
+        const __m128 PASTEND = _mm_cmpnlt_ps(X, ONE);
+        const __m128 BEFORE  = _mm_cmple_ps(X, ZERO);
+        const __m128 SECOND  = _mm_cmpge_ps(X, MIDDLE);
+        const __m128 CLAMPED = _mm_min_ps(_mm_max_ps(X, ZERO), ONE);
+        const __m128 U       = select(SECOND, _mm_sub_ps(ONE, CLAMPED), CLAMPED);
+
+        const __m128  CELL  = _mm_mul_ps(_mm_sqrt_ps(_mm_sqrt_ps(_mm_mul_ps(TWO, U))), CELLS);
+        const __m128i INDEX = _mm_cvttps_epi32(_mm_min_ps(CELL, LASTCELL));
+
+        // no gather in SSE2, but each lane's y, slope, next y and next slope sit next to each other
+        alignas(16) int32_t node[4];
+        _mm_store_si128(rc<__m128i*>(node), _mm_add_epi32(INDEX, _mm_and_si128(_mm_castps_si128(SECOND), _mm_set1_epi32(HALFCELLS + 1))));
+
+        __m128 b0 = _mm_loadu_ps(&m_aBaked[2 * node[0]]);
+        __m128 b1 = _mm_loadu_ps(&m_aBaked[2 * node[1]]);
+        __m128 b2 = _mm_loadu_ps(&m_aBaked[2 * node[2]]);
+        __m128 b3 = _mm_loadu_ps(&m_aBaked[2 * node[3]]);
+        _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+        const __m128 S   = _mm_sub_ps(CELL, _mm_cvtepi32_ps(INDEX));
+        const __m128 S2  = _mm_mul_ps(S, S);
+        const __m128 S3  = _mm_mul_ps(S2, S);
+        const __m128 H00 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(TWO, S3), _mm_mul_ps(THREE, S2)), ONE);
+        const __m128 H10 = _mm_add_ps(_mm_sub_ps(S3, _mm_mul_ps(TWO, S2)), S);
+        const __m128 H01 = _mm_sub_ps(_mm_mul_ps(THREE, S2), _mm_mul_ps(TWO, S3));
+        const __m128 H11 = _mm_sub_ps(S3, S2);
+        const __m128 Y   = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(H00, b0), _mm_mul_ps(H10, b1)), _mm_mul_ps(H01, b2)), _mm_mul_ps(H11, b3));
+
+        const __m128 RESULT = select(PASTEND, ONE, select(BEFORE, ZERO, Y));
+
+        _mm_storeu_ps(&ys[i], RESULT);
+
+        // lanes in cells that are solved for t, see setup4. x comes from the register, the spans may overlap.
+        if (const int SOLVE = _mm_movemask_ps(_mm_cmpunord_ps(RESULT, RESULT)); SOLVE) {
+            alignas(16) float x[4];
+            _mm_store_ps(x, X);
+
+            for (int lane = 0; lane < 4; ++lane) {
+                if (SOLVE & (1 << lane))
+                    ys[i + lane] = getYForPoint(x[lane]);
+            }
+        }
+    }
+#endif
 
-    return LOWERPOINT.y + ((UPPERPOINT.y - LOWERPOINT.y) * PERCINDELTA);
+    for (; i < COUNT; ++i) {
+        ys[i] = getYForPoint(xs[i]);
+    }
 }
 
 const std::vector<Hyprutils::Math::Vector2D>& CBezierCurve::getControlPoints() const {
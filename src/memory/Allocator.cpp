@@ -0,0 +1,11 @@
+#include <hyprutils/memory/Allocator.hpp>
+
+using namespace Hyprutils::Memory;
+
+void Hyprutils::Memory::Impl_::deallocateAllocated(impl_base* impl) noexcept {
+    auto       header = rc<SAllocatedHeader*>(impl) - 1;
+    const auto HEADER = *header;
+
+    impl->~impl_base();
+    HEADER.resource->deallocate(header, HEADER.size, ALLOCATED_ALIGNMENT);
+}
@@ -0,0 +1,92 @@
+#include <hyprutils/memory/BiasedPtr.hpp>
+
+#include <mutex>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+struct Hyprutils::Memory::Biased_::SOwner {
+    // one for the thread itself, one per block it owns
+    std::atomic<size_t>         refs = 1;
+
+    std::mutex                  queueMutex;
+    std::vector<Biased_::impl*> queue;
+    bool                        exited = false;
+};
+
+static void mergeAll(std::vector<Biased_::impl*>& queue) {
+    for (auto& block : queue) {
+        block->mergeQueued();
+        block->decWeak(); // the queue's ref
+    }
+}
+
+namespace {
+    // processes whatever is left in the queue when the owner thread exits
+    struct SOwnerHandle {
+        Biased_::SOwner* owner = nullptr;
+
+        ~SOwnerHandle() {
+            if (!owner)
+                return;
+
+            std::vector<Biased_::impl*> queue;
+            {
+                std::lock_guard lg(owner->queueMutex);
+                owner->exited = true;
+                queue.swap(owner->queue);
+            }
+
+            // from here on, this thread is a non-owner like any other
+            Biased_::tlsOwner = nullptr;
+
+            mergeAll(queue);
+            Biased_::releaseOwner(owner);
+        }
+    };
+
+    thread_local SOwnerHandle ownerHandle;
+}
+
+Biased_::SOwner* Hyprutils::Memory::Biased_::acquireOwner() {
+    if (!tlsOwner) {
+        ownerHandle.owner = new SOwner();
+        tlsOwner          = ownerHandle.owner;
+    }
+
+    tlsOwner->refs.fetch_add(1, std::memory_order_relaxed);
+    return tlsOwner;
+}
+
+void Hyprutils::Memory::Biased_::releaseOwner(SOwner* owner) {
+    if (owner->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete owner;
+}
+
+void Hyprutils::Memory::Biased_::enqueue(SOwner* owner, impl* block) {
+    {
+        std::lock_guard lg(owner->queueMutex);
+        if (!owner->exited) {
+            owner->queue.emplace_back(block);
+            return;
+        }
+    }
+
+    // the owner is gone, so its count can't change anymore and we can merge ourselves
+    block->mergeQueued();
+    block->decWeak();
+}
+
+void Hyprutils::Memory::mergeBiasedRefs() {
+    auto owner = Biased_::tlsOwner;
+    if (!owner)
+        return;
+
+    std::vector<Biased_::impl*> queue;
+    {
+        std::lock_guard lg(owner->queueMutex);
+        queue.swap(owner->queue);
+    }
+
+    mergeAll(queue);
+}
@@ -0,0 +1,70 @@
+#include <hyprutils/memory/DeferredReclaimer.hpp>
+
+using namespace Hyprutils::Memory;
+
+static thread_local CDeferredReclaimer* currentReclaimer = nullptr;
+
+bool Hyprutils::Memory::Impl_::deferDestroy(impl_base* impl) {
+    if (!currentReclaimer)
+        return false;
+
+    if (impl->markQueued())
+        currentReclaimer->m_queue.emplace_back(impl);
+
+    return true;
+}
+
+CDeferredReclaimer::CDeferredReclaimer() : m_previous(currentReclaimer) {
+    currentReclaimer = this;
+}
+
+CDeferredReclaimer::~CDeferredReclaimer() {
+    drain();
+    currentReclaimer = m_previous;
+}
+
+size_t CDeferredReclaimer::drain() {
+    return drainUntil({}, false);
+}
+
+size_t CDeferredReclaimer::drain(std::chrono::nanoseconds budget) {
+    return drainUntil(std::chrono::steady_clock::now() + budget, true);
+}
+
+size_t CDeferredReclaimer::pending() const {
+    return m_queue.size() - m_head;
+}
+
+CDeferredReclaimer* CDeferredReclaimer::current() {
+    return currentReclaimer;
+}
+
+size_t CDeferredReclaimer::drainUntil(std::chrono::steady_clock::time_point deadline, bool bounded) {
+    size_t destroyed = 0;
+
+    // destructors may queue more objects, so don't hold on to any iterator
+    while (m_head < m_queue.size()) {
+        if (bounded && destroyed > 0 && std::chrono::steady_clock::now() >= deadline)
+            break;
+
+        auto impl = m_queue[m_head++];
+
+        impl->destroyQueued();
+
+        // weak pointers leave queued blocks alone, so whatever is left to free is on us
+        if (impl->wref() == 0)
+            Impl_::impl_base::deallocate(impl);
+
+        destroyed++;
+    }
+
+    if (m_head == m_queue.size()) {
+        m_queue.clear();
+        m_head = 0;
+    } else if (m_head > m_queue.size() / 2) {
+        m_queue.erase(m_queue.begin(), m_queue.begin() + m_head);
+        m_head = 0;
+    }
+
+    return destroyed;
+}
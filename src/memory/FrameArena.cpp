@@ -0,0 +1,88 @@
+#include <hyprutils/memory/FrameArena.hpp>
+#include <hyprutils/memory/Casts.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace Hyprutils::Memory;
+
+constexpr size_t CHUNK_ALIGNMENT = alignof(std::max_align_t);
+
+CFrameArena::CFrameArena(size_t chunkSize, std::pmr::memory_resource* upstream) : m_chunkSize(std::max(chunkSize, CHUNK_ALIGNMENT)), m_upstream(upstream) {
+    ;
+}
+
+CFrameArena::~CFrameArena() {
+    for (const auto& c : m_chunks) {
+        m_upstream->deallocate(c.data, c.size, CHUNK_ALIGNMENT);
+    }
+}
+
+void CFrameArena::reset() {
+    m_current = 0;
+    m_offset  = 0;
+    m_used    = 0;
+}
+
+void CFrameArena::trim() {
+    const size_t KEEP = m_chunks.empty() ? 0 : m_current + 1;
+
+    for (size_t i = KEEP; i < m_chunks.size(); ++i) {
+        m_upstream->deallocate(m_chunks[i].data, m_chunks[i].size, CHUNK_ALIGNMENT);
+    }
+
+    m_chunks.resize(KEEP);
+}
+
+size_t CFrameArena::live() const {
+    return m_live;
+}
+
+size_t CFrameArena::used() const {
+    return m_used;
+}
+
+size_t CFrameArena::capacity() const {
+    size_t total = 0;
+    for (const auto& c : m_chunks) {
+        total += c.size;
+    }
+    return total;
+}
+
+void* CFrameArena::do_allocate(size_t bytes, size_t alignment) {
+    while (m_current < m_chunks.size()) {
+        auto&        chunk   = m_chunks[m_current];
+        const auto   ADDRESS = rc<uintptr_t>(chunk.data) + m_offset;
+        const size_t PADDING = (0 - ADDRESS) & (alignment - 1); // alignment is a power of two
+
+        if (m_offset + PADDING + bytes <= chunk.size) {
+            void* p = chunk.data + m_offset + PADDING;
+            m_offset += PADDING + bytes;
+            m_used += PADDING + bytes;
+            m_live++;
+            return p;
+        }
+
+        // doesn't fit, move on to the next chunk. The tail of this one is wasted until the next reset.
+        m_current++;
+        m_offset = 0;
+    }
+
+    // out of chunks, the new one goes last so that reset() walks them in order
+    const size_t SIZE = std::max(m_chunkSize, bytes + alignment);
+    m_chunks.emplace_back(SChunk{.data = sc<unsigned char*>(m_upstream->allocate(SIZE, CHUNK_ALIGNMENT)), .size = SIZE});
+    m_current = m_chunks.size() - 1;
+    m_offset  = 0;
+
+    return do_allocate(bytes, alignment);
+}
+
+void CFrameArena::do_deallocate(void*, size_t, size_t) {
+    // memory is only given back on reset
+    m_live--;
+}
+
+bool CFrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
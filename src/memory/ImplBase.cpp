@@ -0,0 +1,242 @@
+#include <hyprutils/memory/ImplBase.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#define POISON(p, size)   ASAN_POISON_MEMORY_REGION(p, size)
+#define UNPOISON(p, size) ASAN_UNPOISON_MEMORY_REGION(p, size)
+#else
+#define POISON(p, size)
+#define UNPOISON(p, size)
+#endif
+
+using namespace Hyprutils::Memory;
+
+#ifndef HYPRUTILS_NO_CONTROL_BLOCK_POOL
+
+/*
+    Control blocks are allocated from slabs and recycled through per-thread free lists.
+    A block may be freed on another thread than the one that allocated it, in which case it
+    simply moves to the freeing thread's list. Lists that grow too long, and the lists of exited
+    threads, are handed to a global list, which is also the first place a thread refills from.
+    Slabs are never freed.
+*/
+
+constexpr size_t BLOCKSIZE     = sizeof(Impl_::impl_separate);
+constexpr size_t SLABBLOCKS    = 256;
+constexpr size_t MAXTHREADFREE = 4096;
+constexpr size_t REFILLBLOCKS  = 64;
+
+struct SFreeBlock {
+    SFreeBlock* next = nullptr;
+};
+
+static_assert(BLOCKSIZE >= sizeof(SFreeBlock));
+
+// trivially destructible, so it stays usable after the thread's exit hook ran
+struct SThreadPool {
+    SFreeBlock*         head  = nullptr;
+    size_t              count = 0;
+
+    bool                registered = false;
+    bool                exited     = false;
+
+    // only written by the owning thread, read by getControlBlockPoolStats
+    std::atomic<size_t> hits   = 0;
+    std::atomic<size_t> misses = 0;
+};
+
+struct SGlobalPool {
+    std::mutex                mutex;
+    SFreeBlock*               head  = nullptr;
+    size_t                    count = 0;
+
+    std::vector<SThreadPool*> threads;
+    size_t                    retiredHits   = 0;
+    size_t                    retiredMisses = 0;
+    std::atomic<size_t>       slabs         = 0;
+};
+
+// leaked on purpose, blocks can be freed during static destruction
+static SGlobalPool& globalPool() {
+    static auto* pool = new SGlobalPool();
+    return *pool;
+}
+
+static thread_local SThreadPool threadPool;
+
+/* moves up to n blocks from the global list into the thread list, or carves a new slab */
+static void refill(SThreadPool& pool, size_t n) {
+    auto& global = globalPool();
+
+    {
+        std::lock_guard lg(global.mutex);
+        while (global.head && n > 0) {
+            auto block  = global.head;
+            global.head = block->next;
+            global.count--;
+
+            block->next = pool.head;
+            pool.head   = block;
+            pool.count++;
+            n--;
+        }
+    }
+
+    if (pool.head)
+        return;
+
+    auto slab = sc<unsigned char*>(::operator new(BLOCKSIZE * SLABBLOCKS));
+    global.slabs.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < SLABBLOCKS; ++i) {
+        auto block  = rc<SFreeBlock*>(slab + (i * BLOCKSIZE));
+        block->next = pool.head;
+        pool.head   = block;
+        POISON(block + 1, BLOCKSIZE - sizeof(SFreeBlock));
+    }
+
+    pool.count += SLABBLOCKS;
+}
+
+/* hands n blocks from the thread list to the global one */
+static void spill(SThreadPool& pool, size_t n) {
+    auto& global = globalPool();
+
+    std::lock_guard lg(global.mutex);
+    while (pool.head && n > 0) {
+        auto block = pool.head;
+        pool.head  = block->next;
+        pool.count--;
+
+        block->next = global.head;
+        global.head = block;
+        global.count++;
+        n--;
+    }
+}
+
+namespace {
+    struct SThreadExitHook {
+        ~SThreadExitHook() {
+            auto& global = globalPool();
+            spill(threadPool, threadPool.count);
+
+            std::lock_guard lg(global.mutex);
+            std::erase(global.threads, &threadPool);
+            global.retiredHits += threadPool.hits.load(std::memory_order_relaxed);
+            global.retiredMisses += threadPool.misses.load(std::memory_order_relaxed);
+            threadPool.exited = true;
+        }
+    };
+
+    thread_local SThreadExitHook threadExitHook;
+}
+
+static SThreadPool& registeredPool() {
+    if (!threadPool.registered && !threadPool.exited) {
+        threadPool.registered = true;
+        (void)threadExitHook; // odr-use, so the hook is constructed for this thread
+
+        auto&           global = globalPool();
+        std::lock_guard lg(global.mutex);
+        global.threads.emplace_back(&threadPool);
+    }
+
+    return threadPool;
+}
+
+void* Hyprutils::Memory::Impl_::impl_base::operator new(size_t size) {
+    if (size != BLOCKSIZE)
+        return ::operator new(size);
+
+    auto& pool = registeredPool();
+
+    // thread is going away, don't start a new list for it
+    if (pool.exited)
+        return ::operator new(size);
+
+    if (pool.head)
+        pool.hits.store(pool.hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    else {
+        pool.misses.store(pool.misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        refill(pool, REFILLBLOCKS);
+    }
+
+    auto block = pool.head;
+    pool.head  = block->next;
+    pool.count--;
+
+    UNPOISON(block, BLOCKSIZE);
+    return block;
+}
+
+void Hyprutils::Memory::Impl_::impl_base::operator delete(void* p, size_t size) noexcept {
+    if (size != BLOCKSIZE) {
+        ::operator delete(p);
+        return;
+    }
+
+    auto& pool = registeredPool();
+
+    auto  block = sc<SFreeBlock*>(p);
+    block->next = pool.head;
+    pool.head   = block;
+    pool.count++;
+
+    POISON(block + 1, BLOCKSIZE - sizeof(SFreeBlock));
+
+    if (pool.exited)
+        spill(pool, pool.count);
+    else if (pool.count > MAXTHREADFREE)
+        spill(pool, MAXTHREADFREE / 2);
+}
+
+SControlBlockPoolStats Hyprutils::Memory::getControlBlockPoolStats() {
+    auto&                  global = globalPool();
+    SControlBlockPoolStats stats{.enabled = true};
+
+    std::lock_guard        lg(global.mutex);
+    stats.hits   = global.retiredHits;
+    stats.misses = global.retiredMisses;
+    stats.slabs  = global.slabs.load(std::memory_order_relaxed);
+
+    for (const auto& pool : global.threads) {
+        stats.hits += pool->hits.load(std::memory_order_relaxed);
+        stats.misses += pool->misses.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+#else
+
+void* Hyprutils::Memory::Impl_::impl_base::operator new(size_t size) {
+    return ::operator new(size);
+}
+
+void Hyprutils::Memory::Impl_::impl_base::operator delete(void* p, size_t) noexcept {
+    ::operator delete(p);
+}
+
+SControlBlockPoolStats Hyprutils::Memory::getControlBlockPoolStats() {
+    return {};
+}
+
+#endif
+
+void* Hyprutils::Memory::Impl_::allocateFused(size_t size) {
+    return ::operator new(size);
+}
+
+void Hyprutils::Memory::Impl_::freeFused(void* block) noexcept {
+    ::operator delete(block);
+}
+
+void Hyprutils::Memory::Impl_::freeSeparate(impl_base* impl) noexcept {
+    delete sc<impl_separate*>(impl);
+}
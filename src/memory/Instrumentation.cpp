@@ -0,0 +1,135 @@
+#include <hyprutils/memory/Instrumentation.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    struct SBlockRecord {
+        SMemoryTypeStats*                     type = nullptr;
+        std::chrono::steady_clock::time_point created;
+        bool                                  dataDestroyed = false;
+    };
+
+    struct SRegistry {
+        std::mutex                                             mutex;
+        std::unordered_map<const void*, SBlockRecord>          blocks;
+        std::unordered_map<std::string_view, SMemoryTypeStats> types;
+        SMemorySnapshot                                        totals;
+    };
+}
+
+// leaked on purpose, blocks can be freed during static destruction
+static SRegistry& registry() {
+    static auto* reg = new SRegistry();
+    return *reg;
+}
+
+static size_t bucketOf(uint64_t value) {
+    return std::min<size_t>(value ? std::bit_width(value) - 1 : 0, 31);
+}
+
+void Hyprutils::Memory::Impl_::trackCreate(const void* impl, std::string_view type, size_t size) {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    try {
+        auto& stats = reg.types[type];
+        stats.type  = type;
+        stats.live++;
+        stats.total++;
+        stats.peak = std::max(stats.peak, stats.live);
+
+        reg.blocks[impl] = SBlockRecord{.type = &stats, .created = std::chrono::steady_clock::now()};
+    } catch (...) {
+        // out of memory, the block just goes untracked
+        return;
+    }
+
+    reg.totals.liveBlocks++;
+    reg.totals.peakBlocks = std::max(reg.totals.peakBlocks, reg.totals.liveBlocks);
+    reg.totals.sizes[bucketOf(size)]++;
+}
+
+void Hyprutils::Memory::Impl_::trackDataDestroyed(const void* impl) {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    // blocks created by code built without instrumentation are unknown
+    const auto IT = reg.blocks.find(impl);
+    if (IT == reg.blocks.end() || IT->second.dataDestroyed)
+        return;
+
+    auto& record         = IT->second;
+    record.dataDestroyed = true;
+    record.type->zombies++;
+    reg.totals.zombieBlocks++;
+
+    const auto US = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - record.created).count();
+    reg.totals.lifetimes[bucketOf(US)]++;
+}
+
+void Hyprutils::Memory::Impl_::trackFree(const void* impl) {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    const auto      IT = reg.blocks.find(impl);
+    if (IT == reg.blocks.end())
+        return;
+
+    auto& record = IT->second;
+    record.type->live--;
+    reg.totals.liveBlocks--;
+
+    if (record.dataDestroyed) {
+        record.type->zombies--;
+        reg.totals.zombieBlocks--;
+    }
+
+    reg.blocks.erase(IT);
+}
+
+SMemorySnapshot Hyprutils::Memory::getMemorySnapshot() {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    SMemorySnapshot snapshot = reg.totals;
+    snapshot.types.reserve(reg.types.size());
+    for (const auto& [name, stats] : reg.types) {
+        snapshot.types.emplace_back(stats);
+    }
+
+    std::ranges::sort(snapshot.types, [](const auto& a, const auto& b) { return a.live > b.live || (a.live == b.live && a.type < b.type); });
+
+    return snapshot;
+}
+
+std::string Hyprutils::Memory::dumpMemorySnapshot(const SMemorySnapshot& snapshot) {
+    std::string result = "control blocks: " + std::to_string(snapshot.liveBlocks) + " live, " + std::to_string(snapshot.peakBlocks) + " peak, " +
+        std::to_string(snapshot.zombieBlocks) + " zombies\n";
+
+    for (const auto& t : snapshot.types) {
+        result += "  " + std::string{t.type} + ": " + std::to_string(t.live) + " live, " + std::to_string(t.peak) + " peak, " + std::to_string(t.total) + " total, " +
+            std::to_string(t.zombies) + " zombies\n";
+    }
+
+    const auto histogram = [&result](const char* name, const std::array<size_t, 32>& buckets, const char* unit) {
+        result += name;
+        result += ":\n";
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            if (!buckets[i])
+                continue;
+
+            result += "  < " + std::to_string(2ULL << i) + unit + ": " + std::to_string(buckets[i]) + "\n";
+        }
+    };
+
+    histogram("sizes", snapshot.sizes, "B");
+    histogram("lifetimes", snapshot.lifetimes, "us");
+
+    return result;
+}
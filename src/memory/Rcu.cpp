@@ -0,0 +1,173 @@
+#include <hyprutils/memory/Rcu.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+namespace {
+    struct SRetired {
+        void* p                = nullptr;
+        void (*deleter)(void*) = nullptr;
+        /* freeable once no reader is in an older epoch */
+        uint64_t epoch = 0;
+    };
+
+    struct SDomain {
+        std::mutex readersMutex;
+        /* never freed, so grace periods can look at them without the lock */
+        std::vector<Rcu_::SReader*> readers;
+        /* readers of exited threads, up for reuse */
+        std::vector<Rcu_::SReader*> idle;
+
+        std::mutex                  retiredMutex;
+        std::vector<SRetired>       retired;
+    };
+
+    // unregisters the thread's reader when it exits
+    struct SReaderHandle {
+        Rcu_::SReader* reader = nullptr;
+        ~SReaderHandle();
+    };
+
+    thread_local SReaderHandle readerHandle;
+}
+
+// retiring this many objects reclaims on its own
+constexpr size_t AUTO_RECLAIM = 64;
+
+// leaked on purpose, objects can be retired during static destruction
+static SDomain& domain() {
+    static auto* dom = new SDomain();
+    return *dom;
+}
+
+SReaderHandle::~SReaderHandle() {
+    if (!reader)
+        return;
+
+    auto&           dom = domain();
+    std::lock_guard lg(dom.readersMutex);
+    dom.idle.emplace_back(reader);
+    Rcu_::tlsReader = nullptr;
+}
+
+Rcu_::SReader* Hyprutils::Memory::Rcu_::registerReader() {
+    auto&           dom = domain();
+    std::lock_guard lg(dom.readersMutex);
+
+    if (!dom.idle.empty()) {
+        readerHandle.reader = dom.idle.back();
+        dom.idle.pop_back();
+    } else
+        readerHandle.reader = dom.readers.emplace_back(new SReader());
+
+    tlsReader = readerHandle.reader;
+    return tlsReader;
+}
+
+/* frees everything retired up to and including the given epoch */
+static size_t freeRetired(uint64_t epoch) {
+    auto&                 dom = domain();
+    std::vector<SRetired> freeable;
+
+    {
+        std::lock_guard lg(dom.retiredMutex);
+        const auto      IT = std::partition(dom.retired.begin(), dom.retired.end(), [epoch](const auto& r) { return r.epoch > epoch; });
+        freeable.assign(IT, dom.retired.end());
+        dom.retired.erase(IT, dom.retired.end());
+    }
+
+    // deleters may retire more, so they run without the lock
+    for (const auto& r : freeable) {
+        r.deleter(r.p);
+    }
+
+    return freeable.size();
+}
+
+/* bumps the epoch. Done under the retired lock, so that whoever reads the epoch under it
+   also sees every object retired up to that epoch. */
+static uint64_t advanceEpoch() {
+    return Rcu_::globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+}
+
+void Hyprutils::Memory::Rcu_::retire(void* p, void (*deleter)(void*)) {
+    auto&  dom     = domain();
+    size_t pending = 0;
+
+    {
+        std::lock_guard lg(dom.retiredMutex);
+        dom.retired.emplace_back(SRetired{.p = p, .deleter = deleter, .epoch = advanceEpoch()});
+        pending = dom.retired.size();
+    }
+
+    if (pending >= AUTO_RECLAIM)
+        rcuReclaim();
+}
+
+void Hyprutils::Memory::rcuSynchronize() {
+    if (Rcu_::insideReadSection())
+        throw std::logic_error("rcuSynchronize called inside a read section");
+
+    auto&    dom    = domain();
+    uint64_t target = 0;
+    {
+        std::lock_guard lg(dom.retiredMutex);
+        target = advanceEpoch();
+    }
+
+    // order the pointer swaps before reading the reader epochs, pairs with the fence in readLock
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // waiting with the lock held would deadlock with a reader that registers or reclaims inside its section.
+    // Readers that show up later entered after the bump and don't need waiting for.
+    std::vector<Rcu_::SReader*> readers;
+    {
+        std::lock_guard lg(dom.readersMutex);
+        readers = dom.readers;
+    }
+
+    for (const auto& reader : readers) {
+        while (true) {
+            const auto EPOCH = reader->epoch.load(std::memory_order_acquire);
+            if (EPOCH == 0 || EPOCH >= target)
+                break;
+
+            std::this_thread::yield();
+        }
+    }
+
+    freeRetired(target);
+}
+
+size_t Hyprutils::Memory::rcuReclaim() {
+    auto&    dom    = domain();
+    uint64_t oldest = 0;
+    {
+        std::lock_guard lg(dom.retiredMutex);
+        oldest = Rcu_::globalEpoch.load(std::memory_order_seq_cst);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // everything retired before the oldest open read section is safe
+    {
+        std::lock_guard lg(dom.readersMutex);
+        for (const auto& reader : dom.readers) {
+            const auto EPOCH = reader->epoch.load(std::memory_order_acquire);
+            if (EPOCH != 0)
+                oldest = std::min(oldest, EPOCH);
+        }
+    }
+
+    return freeRetired(oldest);
+}
+
+size_t Hyprutils::Memory::rcuPending() {
+    auto&           dom = domain();
+    std::lock_guard lg(dom.retiredMutex);
+    return dom.retired.size();
+}
@@ -0,0 +1,140 @@
+#include <hyprutils/signal/Instrumentation.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+using namespace Hyprutils::Signal;
+
+namespace Hyprutils::Signal::Impl_ {
+    // updated from whichever thread emits, without taking the registry lock
+    struct SSignalRecord {
+        std::atomic<size_t>   emits     = 0;
+        std::atomic<size_t>   calls     = 0;
+        std::atomic<size_t>   maxFanOut = 0;
+        std::atomic<uint64_t> totalNs   = 0;
+        std::atomic<uint64_t> maxNs     = 0;
+    };
+
+    struct SListenerRecord {
+        std::atomic<size_t>   calls   = 0;
+        std::atomic<uint64_t> totalNs = 0;
+        std::atomic<uint64_t> maxNs   = 0;
+    };
+}
+
+namespace {
+    struct SRegistry {
+        std::mutex                                              mutex;
+        std::unordered_map<std::string, Impl_::SSignalRecord>   signals;
+        std::unordered_map<std::string, Impl_::SListenerRecord> listeners;
+    };
+}
+
+// leaked on purpose, records are pointed to until the very end
+static SRegistry& registry() {
+    static auto* reg = new SRegistry();
+    return *reg;
+}
+
+template <typename T>
+static void raise(std::atomic<T>& max, T value) {
+    T current = max.load(std::memory_order_relaxed);
+    while (current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        ;
+    }
+}
+
+Impl_::SSignalRecord* Hyprutils::Signal::Impl_::signalRecord(std::string_view name) {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    // unordered_map nodes are stable, the record can be handed out
+    return &reg.signals.try_emplace(std::string{name}).first->second;
+}
+
+Impl_::SListenerRecord* Hyprutils::Signal::Impl_::listenerRecord(const std::source_location& location) {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    return &reg.listeners.try_emplace(std::string{location.file_name()} + ":" + std::to_string(location.line())).first->second;
+}
+
+uint64_t Hyprutils::Signal::Impl_::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Hyprutils::Signal::Impl_::recordEmit(SSignalRecord* record, size_t fanOut, uint64_t ns) {
+    record->emits.fetch_add(1, std::memory_order_relaxed);
+    record->calls.fetch_add(fanOut, std::memory_order_relaxed);
+    record->totalNs.fetch_add(ns, std::memory_order_relaxed);
+    raise(record->maxFanOut, fanOut);
+    raise(record->maxNs, ns);
+}
+
+void Hyprutils::Signal::Impl_::recordCall(SListenerRecord* record, uint64_t ns) {
+    if (!record)
+        return;
+
+    record->calls.fetch_add(1, std::memory_order_relaxed);
+    record->totalNs.fetch_add(ns, std::memory_order_relaxed);
+    raise(record->maxNs, ns);
+}
+
+SSignalSnapshot Hyprutils::Signal::getSignalSnapshot() {
+    auto&           reg = registry();
+    std::lock_guard lg(reg.mutex);
+
+    SSignalSnapshot snapshot;
+    snapshot.signals.reserve(reg.signals.size());
+    for (const auto& [name, r] : reg.signals) {
+        snapshot.signals.emplace_back(SSignalStats{
+            .name      = name,
+            .emits     = r.emits.load(std::memory_order_relaxed),
+            .calls     = r.calls.load(std::memory_order_relaxed),
+            .maxFanOut = r.maxFanOut.load(std::memory_order_relaxed),
+            .totalNs   = r.totalNs.load(std::memory_order_relaxed),
+            .maxNs     = r.maxNs.load(std::memory_order_relaxed),
+        });
+    }
+
+    snapshot.listeners.reserve(reg.listeners.size());
+    for (const auto& [location, r] : reg.listeners) {
+        snapshot.listeners.emplace_back(SListenerStats{
+            .location = location,
+            .calls    = r.calls.load(std::memory_order_relaxed),
+            .totalNs  = r.totalNs.load(std::memory_order_relaxed),
+            .maxNs    = r.maxNs.load(std::memory_order_relaxed),
+        });
+    }
+
+    std::ranges::sort(snapshot.signals, [](const auto& a, const auto& b) { return a.totalNs > b.totalNs || (a.totalNs == b.totalNs && a.name < b.name); });
+    std::ranges::sort(snapshot.listeners, [](const auto& a, const auto& b) { return a.totalNs > b.totalNs || (a.totalNs == b.totalNs && a.location < b.location); });
+
+    return snapshot;
+}
+
+/* a fraction with one decimal */
+static std::string decimal(uint64_t numerator, uint64_t denominator) {
+    const uint64_t TENTHS = denominator ? numerator * 10 / denominator : 0;
+    return std::to_string(TENTHS / 10) + "." + std::to_string(TENTHS % 10);
+}
+
+std::string Hyprutils::Signal::dumpSignalSnapshot(const SSignalSnapshot& snapshot) {
+    std::string result = "signals:\n";
+
+    for (const auto& s : snapshot.signals) {
+        result += "  " + s.name + ": " + std::to_string(s.emits) + " emits, " + decimal(s.calls, s.emits) + " avg fan-out, " + std::to_string(s.maxFanOut) + " max fan-out, " +
+            decimal(s.totalNs, 1000) + "us total, " + decimal(s.maxNs, 1000) + "us max\n";
+    }
+
+    result += "listeners:\n";
+
+    for (const auto& l : snapshot.listeners) {
+        result += "  " + l.location + ": " + std::to_string(l.calls) + " calls, " + decimal(l.totalNs, 1000) + "us total, " + decimal(l.maxNs, 1000) + "us max\n";
+    }
+
+    return result;
+}
@@ -1,20 +1,76 @@
 #include <hyprutils/signal/Listener.hpp>
-#include <tuple>
 
 using namespace Hyprutils::Signal;
 
-Hyprutils::Signal::CSignalListener::CSignalListener(std::function<void(void*)> handler) : m_fHandler(handler) {
-    ;
+Hyprutils::Signal::CSignalListener::~CSignalListener() {
+    if (m_pList)
+        m_pList->unlink(this);
 }
 
-void Hyprutils::Signal::CSignalListener::emitInternal(void* data) {
-    if (!m_fHandler)
-        return;
+void Hyprutils::Signal::CSignalListener::emit(std::any data) {
+    // single argument handlers take a pointer to their argument
+    m_fUntyped(this, &data);
+}
+
+void Hyprutils::Signal::SListenerList::insert(CSignalListener* listener, int32_t priority) {
+    // after every listener of the same or higher priority, which is the tail unless priorities are used
+    auto after = tail;
+    while (after && after->m_priority < priority) {
+        after = after->m_pPrev;
+    }
+
+    listener->m_pList      = this;
+    listener->m_pPrev      = after;
+    listener->m_pNext      = after ? after->m_pNext : head;
+    listener->m_priority   = priority;
+    listener->m_generation = ++generation;
 
-    m_fHandler(data);
+    if (listener->m_pNext)
+        listener->m_pNext->m_pPrev = listener;
+    else
+        tail = listener;
+
+    if (after)
+        after->m_pNext = listener;
+    else
+        head = listener;
 }
 
-void Hyprutils::Signal::CSignalListener::emit(std::any data) {
-    auto dataTuple = std::tuple<std::any>(data);
-    emitInternal(&dataTuple);
+void Hyprutils::Signal::SListenerList::unlink(CSignalListener* listener) {
+    if (listener->m_pPrev)
+        listener->m_pPrev->m_pNext = listener->m_pNext;
+    else
+        head = listener->m_pNext;
+
+    if (listener->m_pNext)
+        listener->m_pNext->m_pPrev = listener->m_pPrev;
+    else
+        tail = listener->m_pPrev;
+
+    listener->m_pList = nullptr;
+    listener->m_pPrev = nullptr;
+    listener->m_pNext = nullptr;
+}
+
+void Hyprutils::Signal::SListenerList::moveTo(SListenerList& other) {
+    other = *this;
+    for (auto l = head; l; l = l->m_pNext) {
+        l->m_pList = &other;
+    }
+
+    head = nullptr;
+    tail = nullptr;
+}
+
+void Hyprutils::Signal::SListenerList::detachAll() {
+    for (auto l = head; l;) {
+        const auto NEXT = l->m_pNext;
+        l->m_pList      = nullptr;
+        l->m_pPrev      = nullptr;
+        l->m_pNext      = nullptr;
+        l               = NEXT;
+    }
+
+    head = nullptr;
+    tail = nullptr;
 }
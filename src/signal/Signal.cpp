@@ -2,59 +2,201 @@
 #include <hyprutils/signal/Signal.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
 #include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 using namespace Hyprutils::Signal;
 using namespace Hyprutils::Memory;
+using namespace Hyprutils::OS;
 
 #define SP CSharedPointer
 #define WP CWeakPointer
 
-void Hyprutils::Signal::CSignalBase::emitInternal(void* args) {
-    std::vector<SP<CSignalListener>> listeners;
-    listeners.reserve(m_vListeners.size());
-    for (auto& l : m_vListeners) {
-        if (l.expired())
-            continue;
+/*
+    Emitting walks the signal's list of listeners, taking a strong ref to each one while calling it, so it doesn't allocate.
+    Only the listeners present when the emit started are called, later ones have a higher generation.
+    Removed listeners unlinked themselves already.
+    If the signal dies inside a handler, its listeners move into the outermost frame,
+    which lets the emits in progress finish with the listeners they started with.
+*/
+Hyprutils::Signal::CSignalBase::SEmitFrame::SEmitFrame(CSignalBase* signal_) :
+    prev(signal_->m_pEmitFrame), signal(signal_), listeners(&signal_->m_listeners), members(&signal_->m_vMemberListeners), statics(&signal_->m_vStaticListeners) {
+    signal->m_pEmitFrame = this;
+}
+
+Hyprutils::Signal::CSignalBase::SEmitFrame::~SEmitFrame() {
+    if (signal)
+        signal->m_pEmitFrame = prev;
+    else if (listeners == &orphanedListeners)
+        orphanedListeners.detachAll();
+}
+
+Hyprutils::Signal::CSignalBase::~CSignalBase() {
+    orphanListeners();
+}
 
-        listeners.emplace_back(l.lock());
+void Hyprutils::Signal::CSignalBase::orphanListeners() {
+    if (!m_pEmitFrame) {
+        m_listeners.detachAll();
+        m_vMemberListeners.clear();
+        m_vStaticListeners.clear();
+        return;
     }
 
-    auto statics = m_vStaticListeners;
+    auto outermost = m_pEmitFrame;
+    while (outermost->prev) {
+        outermost = outermost->prev;
+    }
 
-    for (auto& l : listeners) {
-        // if there is only one lock, it means the event is only held by the listeners
-        // vector and was removed during our iteration
-        if (l.strongRef() == 1)
-            continue;
+    m_listeners.moveTo(outermost->orphanedListeners);
+    outermost->orphanedMembers = std::move(m_vMemberListeners);
+    outermost->orphanedStatics = std::move(m_vStaticListeners);
+    m_vMemberListeners.clear();
+    m_vStaticListeners.clear();
 
-        l->emitInternal(args);
+    for (auto frame = m_pEmitFrame; frame; frame = frame->prev) {
+        frame->signal    = nullptr;
+        frame->listeners = &outermost->orphanedListeners;
+        frame->members   = &outermost->orphanedMembers;
+        frame->statics   = &outermost->orphanedStatics;
     }
 
-    for (auto& l : statics) {
-        l->emitInternal(args);
+    m_pEmitFrame = nullptr;
+}
+
+void Hyprutils::Signal::CSignalBase::adoptListeners(CSignalBase& other) {
+    other.m_listeners.moveTo(m_listeners);
+    m_vMemberListeners = std::move(other.m_vMemberListeners);
+    m_vStaticListeners = std::move(other.m_vStaticListeners);
+    m_bMembersExpired  = std::exchange(other.m_bMembersExpired, false);
+    other.m_vMemberListeners.clear();
+    other.m_vStaticListeners.clear();
+
+    // emits in progress go on with this signal
+    m_pEmitFrame = std::exchange(other.m_pEmitFrame, nullptr);
+    for (auto frame = m_pEmitFrame; frame; frame = frame->prev) {
+        frame->signal    = this;
+        frame->listeners = &m_listeners;
+        frame->members   = &m_vMemberListeners;
+        frame->statics   = &m_vStaticListeners;
     }
 
-    // release SPs
-    listeners.clear();
+    m_pRecord = other.m_pRecord;
+}
 
-    // we cannot release any expired refs here as one of the listeners could've removed this object and
-    // as such we'd be doing a UAF
+Hyprutils::Signal::CSignalBase::CSignalBase(CSignalBase&& other) noexcept {
+    adoptListeners(other);
 }
 
-CHyprSignalListener Hyprutils::Signal::CSignalBase::registerListenerInternal(std::function<void(void*)> handler) {
-    CHyprSignalListener listener = SP<CSignalListener>(new CSignalListener(handler));
-    m_vListeners.emplace_back(listener);
+CSignalBase& Hyprutils::Signal::CSignalBase::operator=(CSignalBase&& other) noexcept {
+    if (this == &other)
+        return *this;
 
-    // housekeeping: remove any stale listeners
-    std::erase_if(m_vListeners, [](const auto& other) { return other.expired(); });
+    orphanListeners();
+    adoptListeners(other);
+    return *this;
+}
 
+CHyprSignalListener Hyprutils::Signal::CSignalBase::registerListenerInternal(CHyprSignalListener listener, int32_t priority) {
+    m_listeners.insert(listener.get(), priority);
     return listener;
 }
 
-void Hyprutils::Signal::CSignalBase::registerStaticListenerInternal(std::function<void(void*)> handler) {
-    m_vStaticListeners.emplace_back(SP<CSignalListener>(new CSignalListener(handler)));
+void Hyprutils::Signal::CSignalBase::registerStaticListenerInternal(CHyprSignalListener listener) {
+    m_vStaticListeners.emplace_back(std::move(listener));
+}
+
+void Hyprutils::Signal::CSignalBase::registerMemberListenerInternal(SMemberListener&& listener) {
+    // owners may die without the signal being emitted, so look for them before growing
+    if (m_vMemberListeners.size() == m_vMemberListeners.capacity() && !m_pEmitFrame)
+        eraseExpiredMembers();
+
+    m_vMemberListeners.emplace_back(std::move(listener));
+}
+
+void Hyprutils::Signal::CSignalBase::eraseExpiredMembers() {
+    std::erase_if(m_vMemberListeners, [](const SMemberListener& listener) { return listener.owner.expired(); });
+    m_bMembersExpired = false;
 }
 
 void Hyprutils::Signal::CSignal::emit(std::any data) {
     CSignalT::emit(data);
 }
+
+/*
+    An intrusive MPSC queue after Dmitry Vyukov's: producers exchange the head and then link the previous node to theirs,
+    the owner pops from the tail. The stub node keeps the queue from ever being really empty,
+    so popping the last node doesn't race with a push.
+    A producer only writes to the eventfd if nobody did since the owner last acknowledged.
+*/
+Hyprutils::Signal::CCrossThreadQueue::CCrossThreadQueue() : m_head(&m_stub), m_tail(&m_stub), m_eventFD(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    // without it, wakeups would silently go nowhere
+    if (!m_eventFD.isValid())
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+}
+
+void Hyprutils::Signal::CCrossThreadQueue::link(SNode* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+void Hyprutils::Signal::CCrossThreadQueue::push(SNode* node) {
+    link(node);
+
+    if (m_wakePending.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    // a nonblocking eventfd only refuses a write when its counter would overflow, which a single 1 per wakeup can't do
+    const uint64_t ONE = 1;
+    (void)!write(m_eventFD.get(), &ONE, sizeof(ONE));
+}
+
+Hyprutils::Signal::CCrossThreadQueue::SNode* Hyprutils::Signal::CCrossThreadQueue::pop() {
+    auto tail = m_tail;
+    auto next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &m_stub) {
+        if (!next)
+            return nullptr;
+
+        m_tail = next;
+        tail   = next;
+        next   = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+        m_tail = next;
+        return tail;
+    }
+
+    // a producer exchanged the head but didn't link its node yet
+    if (tail != m_head.load(std::memory_order_acquire))
+        return nullptr;
+
+    // tail is the last node, put the stub behind it so it can be taken
+    link(&m_stub);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (!next)
+        return nullptr;
+
+    m_tail = next;
+    return tail;
+}
+
+void Hyprutils::Signal::CCrossThreadQueue::acknowledge() {
+    // drain the eventfd first, a push after clearing the flag must leave it readable
+    uint64_t count = 0;
+    (void)!read(m_eventFD.get(), &count, sizeof(count));
+
+    m_wakePending.exchange(false, std::memory_order_acq_rel);
+}
+
+const CFileDescriptor& Hyprutils::Signal::CCrossThreadQueue::getFD() const {
+    return m_eventFD;
+}
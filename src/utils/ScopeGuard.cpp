@@ -2,7 +2,7 @@
 
 using namespace Hyprutils::Utils;
 
-Hyprutils::Utils::CScopeGuard::CScopeGuard(const std::function<void()>& fn_) : fn(fn_) {
+Hyprutils::Utils::CScopeGuard::CScopeGuard(CFunction<void()> fn_) : fn(std::move(fn_)) {
     ;
 }
 
@@ -392,4 +392,81 @@ TEST(Animation, animation) {
     } // a gets destroyed
 
     EXPECT_EQ(pAnimationManager.get(), nullptr);
-}
\ No newline at end of file
+}
+
+/* uses the built-in tick instead */
+class CTickedAnimationManager : public CMyAnimationManager {
+  public:
+    using CAnimationManager::tick;
+};
+
+TEST(Animation, tick) {
+    CTickedAnimationManager manager;
+    manager.addBezierWithName("linear", Vector2D(0, 0), Vector2D(1, 1));
+
+    animationTree.createNode("ticked");
+    animationTree.setConfigForNode("ticked", 1, 1.f /* 100ms */, "linear");
+
+    manager.setTickHandler<int, EmtpyContext>(eAVTypes::INT);
+
+    PANIMVAR<int>          a;
+    PANIMVAR<int>          b;
+    PANIMVAR<SomeTestType> c;
+    manager.createAnimation(0, a, "ticked");
+    manager.createAnimation(0, b, "ticked");
+    manager.createAnimation({}, c, "ticked");
+
+    const auto BEGIN = std::chrono::steady_clock::now();
+    *a               = 100;
+    *b               = 200;
+    *c               = SomeTestType(true);
+
+    std::vector<std::string> order;
+    int                      bSeenByA = -1;
+    a->setUpdateCallback([&](auto) {
+        order.emplace_back("update a");
+        bSeenByA = b->value();
+    });
+    b->setUpdateCallback([&](auto) { order.emplace_back("update b"); });
+    a->setCallbackOnEnd([&](auto) { order.emplace_back("end a"); });
+    b->setCallbackOnEnd([&](auto) { order.emplace_back("end b"); });
+
+    manager.tick(BEGIN + std::chrono::milliseconds(50));
+
+    EXPECT_NEAR(a->value(), 50, 2);
+    EXPECT_NEAR(b->value(), 100, 3);
+    // every value is set before the first callback runs
+    EXPECT_EQ(bSeenByA, b->value());
+    EXPECT_EQ(order, (std::vector<std::string>{"update a", "update b"}));
+
+    order.clear();
+    manager.tick(BEGIN + std::chrono::milliseconds(200));
+
+    EXPECT_EQ(a->value(), 100);
+    EXPECT_EQ(b->value(), 200);
+    EXPECT_EQ(order, (std::vector<std::string>{"update a", "update b", "end a", "end b"}));
+
+    // c has no handler for its type and is left alone
+    EXPECT_EQ(c->value().done, false);
+    EXPECT_EQ(manager.m_vActiveAnimatedVariables.size(), 1);
+
+    manager.setTickHandler<SomeTestType, EmtpyContext>(eAVTypes::TEST, [](const SomeTestType& begun, const SomeTestType&, float) { return SomeTestType{.done = begun.done}; });
+
+    manager.tick(BEGIN + std::chrono::milliseconds(50));
+    EXPECT_EQ(c->value().done, false);
+
+    manager.tick(BEGIN + std::chrono::milliseconds(200));
+    EXPECT_EQ(c->value().done, true);
+    EXPECT_EQ(manager.shouldTickForNext(), false);
+
+    // an end callback restarting its own animation
+    *a = 50;
+    a->setCallbackOnEnd([](WP<CBaseAnimatedVariable> v) { *dc<CAnimatedVariable<int>*>(v.get()) = 0; });
+
+    manager.tick(std::chrono::steady_clock::now() + std::chrono::milliseconds(200));
+    EXPECT_EQ(a->value(), 50);
+    EXPECT_EQ(a->goal(), 0);
+    EXPECT_EQ(manager.shouldTickForNext(), true);
+
+    a->warp(false);
+}
@@ -1,4 +1,6 @@
 #include <cmath>
+#include <limits>
+#include <vector>
 #include <hyprutils/animation/BezierCurve.hpp>
 
 #include <gtest/gtest.h>
@@ -72,8 +74,88 @@ static void test_all_baked_x_equal() {
     EXPECT_EQ((y_hi >= 0.0f && y_hi <= 1.0f), true);
 }
 
+// y at x by bisecting the x polynomial in double, for curves that are monotonic in x
+static double exactYForX(const std::array<Vector2D, 2>& p, double x) {
+    const auto at = [](double b, double c, double t) {
+        const double U = 1 - t;
+        return (3 * t * U * U * b) + (3 * t * t * U * c) + (t * t * t);
+    };
+
+    double lo = 0;
+    double hi = 1;
+    for (int i = 0; i < 64; ++i) {
+        const double T = (lo + hi) / 2;
+        if (at(p[0].x, p[1].x, T) < x)
+            lo = T;
+        else
+            hi = T;
+    }
+
+    return at(p[0].y, p[1].y, (lo + hi) / 2);
+}
+
+static void test_accuracy() {
+    // the usual easings, some with control points right at the ends where the curve goes vertical
+    const std::vector<std::array<Vector2D, 2>> CURVES = {
+        {Vector2D{0.0, 0.0}, Vector2D{1.0, 1.0}},    {Vector2D{0.25, 0.1}, Vector2D{0.25, 1.0}}, {Vector2D{0.42, 0.0}, Vector2D{0.58, 1.0}},
+        {Vector2D{0.05, 0.9}, Vector2D{0.1, 1.05}},  {Vector2D{0.0, 1.0}, Vector2D{0.0, 1.0}},   {Vector2D{1.0, 0.0}, Vector2D{1.0, 0.0}},
+        {Vector2D{0.0, 0.5}, Vector2D{1.0, 0.5}},    {Vector2D{0.34, 1.56}, Vector2D{0.64, 1.0}}, {Vector2D{0.68, -0.6}, Vector2D{0.32, 1.6}},
+        {Vector2D{0.0, 0.0}, Vector2D{0.0, 1.0}},    {Vector2D{1.0, 0.0}, Vector2D{1.0, 1.0}},   {Vector2D{0.3, 0.0}, Vector2D{0.7, 0.0}},
+        // vertical halfway, y goes like a cube root around x = 0.5
+        {Vector2D{1.0, 0.0}, Vector2D{0.0, 1.0}},    {Vector2D{1.0, 0.2}, Vector2D{0.0, 0.8}},
+    };
+
+    for (const auto& p : CURVES) {
+        CBezierCurve curve;
+        curve.setup(p);
+
+        double worst = 0;
+        for (int i = 0; i <= 10000; ++i) {
+            const float X = i / 10000.F;
+            worst         = std::max(worst, std::abs(curve.getYForPoint(X) - exactYForX(p, X)));
+        }
+
+        EXPECT_LT(worst, 2e-5) << "curve " << p[0].x << ", " << p[0].y << ", " << p[1].x << ", " << p[1].y;
+    }
+}
+
+static void test_batch_matches_single() {
+    CBezierCurve curve;
+    curve.setup({Vector2D{0.05, 0.9}, Vector2D{0.1, 1.05}});
+
+    // odd count, so the tail past the last full batch gets used too
+    std::vector<float> xs;
+    for (int i = 0; i < 1001; ++i) {
+        xs.emplace_back(((i * 7919) % 1001) / 1000.F);
+    }
+    xs.insert(xs.end(), {-1.F, 0.F, 0.5F, 1.F, 2.F, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), 1e-30F, 1.F - 1e-7F});
+
+    std::vector<float> ys(xs.size());
+    curve.getYForPoints(xs, ys);
+
+    for (size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_EQ(ys[i], curve.getYForPoint(xs[i])) << "x " << xs[i];
+    }
+
+    // only as many as both spans hold
+    std::vector<float> few(3, -1.F);
+    curve.getYForPoints(xs, few);
+    EXPECT_EQ(few[2], curve.getYForPoint(xs[2]));
+
+    // cells solved for t, in place
+    curve.setup({Vector2D{1.0, 0.0}, Vector2D{0.0, 1.0}});
+    std::vector<float> inPlace = xs;
+    curve.getYForPoints(inPlace, inPlace);
+
+    for (size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_EQ(inPlace[i], curve.getYForPoint(xs[i])) << "x " << xs[i];
+    }
+}
+
 TEST(Animation, beziercurve) {
     test_nonmonotonic4_clamps_out_of_range();
     test_adjacent_baked_x_equal();
     test_all_baked_x_equal();
-}
\ No newline at end of file
+    test_accuracy();
+    test_batch_matches_single();
+}
@@ -1,10 +1,19 @@
 
 #include <hyprutils/memory/Atomic.hpp>
+#include <hyprutils/memory/BiasedPtr.hpp>
+#include <hyprutils/memory/DeferredReclaimer.hpp>
+#include <hyprutils/memory/Allocator.hpp>
+#include <hyprutils/memory/FrameArena.hpp>
+#include <hyprutils/memory/SelfReferencing.hpp>
+#include <hyprutils/memory/Instrumentation.hpp>
 #include <hyprutils/memory/SharedPtr.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -80,6 +89,32 @@ static void testAtomicImpl() {
         EXPECT_EQ(weak.expired(), true);
     }
 
+    { // Weak refs dropped concurrently with the last strong ref
+        for (size_t round = 0; round < 100; round++) {
+            ASP<int>                 shared = makeAtomicShared<int>(0);
+            std::vector<std::thread> threads;
+
+            threads.reserve(NTHREADS);
+            for (size_t i = 0; i < NTHREADS; i++) {
+                threads.emplace_back([weak = AWP<int>(shared)]() mutable {
+                    for (size_t j = 0; j < 100; j++) {
+                        AWP<int> copy = weak;
+                        if (auto s = copy.lock(); s) {
+                            EXPECT_EQ(*s, 0);
+                        }
+                    }
+                    weak.reset();
+                });
+            }
+
+            shared.reset();
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    }
+
     { // This tests recursive deletion. When foo will be deleted, bar will be deleted within the foo dtor.
         class CFoo {
           public:
@@ -123,6 +158,533 @@ static void testAtomicImpl() {
     }
 }
 
+static void testFused() {
+    { // weak pointers to self are still usable in the destructor
+        class CFoo {
+          public:
+            ~CFoo() {
+                EXPECT_EQ(self.valid(), true);
+                EXPECT_EQ(self.expired(), true);
+                EXPECT_EQ(self->num, 1337);
+                EXPECT_EQ(!!self.lock(), false);
+            }
+
+            int      num = 1337;
+            WP<CFoo> self;
+        };
+
+        auto foo  = makeShared<CFoo>();
+        foo->self = foo;
+        EXPECT_EQ(foo.impl_->fused(), true);
+        EXPECT_EQ(rc<uintptr_t>(foo.get()) - rc<uintptr_t>(foo.impl_), sizeof(Impl_::impl_base));
+    }
+
+    { // the block outlives the data while weak refs exist
+        WP<int> weak;
+        {
+            auto shared = makeShared<int>(69);
+            weak        = shared;
+        }
+
+        EXPECT_EQ(weak.expired(), true);
+        EXPECT_EQ(weak.valid(), false);
+        EXPECT_EQ(weak.impl_->wref(), 1);
+        EXPECT_EQ(weak.get(), nullptr);
+    }
+
+    { // unique pointers are fused too
+        auto    unique = makeUnique<int>(42);
+        WP<int> weak   = unique;
+        EXPECT_EQ(unique.impl_->fused(), true);
+        EXPECT_EQ(unique.impl_->lockable(), false);
+        unique.reset();
+        EXPECT_EQ(weak.expired(), true);
+    }
+
+    { // overaligned types get two allocations
+        struct alignas(64) SAligned {
+            int num = 0;
+        };
+
+        auto aligned = makeShared<SAligned>();
+        EXPECT_EQ(aligned.impl_->fused(), false);
+        EXPECT_EQ(rc<uintptr_t>(aligned.get()) % 64, 0);
+    }
+
+    { // a throwing constructor doesn't leak the block
+        struct SThrows {
+            SThrows() {
+                throw std::runtime_error("nope");
+            }
+        };
+
+        EXPECT_THROW(makeShared<SThrows>(), std::runtime_error);
+    }
+}
+
+static void testAtomicSlot() {
+    struct SSnapshot {
+        SSnapshot(size_t gen, std::atomic<int>& alive) : gen(gen), alive(alive) {
+            alive++;
+        }
+
+        ~SSnapshot() {
+            alive--;
+        }
+
+        size_t            gen = 0;
+        std::atomic<int>& alive;
+    };
+
+    std::atomic<int> alive = 0;
+
+    {
+        CAtomicSharedSlot<SSnapshot> slot;
+        EXPECT_EQ(!!slot, false);
+        EXPECT_EQ(slot.load().get(), nullptr);
+
+        slot.store(makeAtomicShared<SSnapshot>(0, alive));
+
+        std::atomic<bool>        done = false;
+        std::vector<std::thread> readers;
+
+        readers.reserve(NTHREADS);
+        for (size_t i = 0; i < NTHREADS; i++) {
+            readers.emplace_back([&slot, &done]() {
+                size_t last = 0;
+                while (!done) {
+                    auto snapshot = slot.load();
+                    EXPECT_EQ(!!snapshot, true);
+                    EXPECT_GE(snapshot->gen, last);
+                    last = snapshot->gen;
+                }
+            });
+        }
+
+        for (size_t gen = 1; gen < ITERATIONS; gen++) {
+            if (gen % 2)
+                slot.store(makeAtomicShared<SSnapshot>(gen, alive));
+            else
+                slot.exchange(makeAtomicShared<SSnapshot>(gen, alive));
+        }
+
+        done = true;
+        for (auto& thread : readers) {
+            thread.join();
+        }
+
+        EXPECT_EQ(alive, 1);
+        EXPECT_EQ(slot.load()->gen, ITERATIONS - 1);
+        EXPECT_EQ(slot.load().strongRef(), 2);
+
+        auto expected = makeAtomicShared<SSnapshot>(1337, alive);
+        EXPECT_EQ(slot.compareExchange(expected, makeAtomicShared<SSnapshot>(1338, alive)), false);
+        EXPECT_EQ(expected->gen, ITERATIONS - 1);
+        EXPECT_EQ(slot.compareExchange(expected, makeAtomicShared<SSnapshot>(1338, alive)), true);
+        EXPECT_EQ(slot.load()->gen, 1338);
+
+        expected.reset();
+        EXPECT_EQ(alive, 1);
+    }
+
+    EXPECT_EQ(alive, 0);
+}
+
+static void testBiased() {
+    std::atomic<int> destroyed = 0;
+
+    struct SObj {
+        SObj(std::atomic<int>& destroyed) : destroyed(destroyed) {
+            ;
+        }
+
+        ~SObj() {
+            destroyed++;
+        }
+
+        std::atomic<int>& destroyed;
+    };
+
+    { // owner-only refcounting
+        auto                 shared = makeBiasedShared<SObj>(destroyed);
+        CBiasedWeakPointer<SObj> weak = shared;
+        auto                 copy   = shared;
+        shared.reset();
+        EXPECT_EQ(weak.valid(), true);
+        EXPECT_EQ(!!weak.lock(), true);
+        copy.reset();
+        EXPECT_EQ(destroyed, 1);
+        EXPECT_EQ(weak.expired(), true);
+        EXPECT_EQ(!!weak.lock(), false);
+    }
+
+    { // refs handed off to other threads, the owner drops out first
+        auto                     shared = makeBiasedShared<SObj>(destroyed);
+        std::vector<std::thread> threads;
+
+        threads.reserve(NTHREADS);
+        for (size_t i = 0; i < NTHREADS; i++) {
+            threads.emplace_back([copy = shared, weak = CBiasedWeakPointer<SObj>(shared)]() mutable {
+                for (size_t j = 0; j < ITERATIONS / 10; j++) {
+                    auto another = copy;
+                    auto locked  = weak.lock();
+                    EXPECT_EQ(!!locked, true);
+                }
+                copy.reset();
+            });
+        }
+
+        shared.reset();
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // the captured copies were counted by the owner, so it has to merge them
+        EXPECT_EQ(destroyed, 1);
+        mergeBiasedRefs();
+        EXPECT_EQ(destroyed, 2);
+    }
+
+    { // the owner thread exits while its refs are still around
+        CBiasedSharedPointer<SObj> shared;
+        std::thread                owner([&] { shared = makeBiasedShared<SObj>(destroyed); });
+        owner.join();
+
+        CBiasedWeakPointer<SObj> weak = shared;
+        EXPECT_EQ(!!weak.lock(), true);
+        shared.reset();
+        EXPECT_EQ(destroyed, 3);
+        EXPECT_EQ(!!weak.lock(), false);
+    }
+}
+
+static void testCompactBlock() {
+    EXPECT_EQ(sizeof(Impl_::impl_base), 16);
+
+    // flags live in the strong count, they must not show up in it
+    auto    unique     = makeUnique<int>(1);
+    WP<int> weakUnique = unique;
+    EXPECT_EQ(unique.impl_->ref(), 1);
+    EXPECT_EQ(unique.impl_->lockable(), false);
+    unique.reset();
+    EXPECT_EQ(weakUnique.impl_->ref(), 0);
+    EXPECT_EQ(weakUnique.get(), nullptr);
+
+    auto atomic = makeAtomicShared<int>(1);
+    auto copy   = atomic;
+    EXPECT_EQ(atomic.strongRef(), 2);
+
+    SP<int> null(sc<int*>(nullptr));
+    WP<int> weakNull = null;
+    EXPECT_EQ(!!null, false);
+    EXPECT_EQ(weakNull.valid(), false);
+    EXPECT_EQ(!!weakNull.lock(), false);
+}
+
+static void testDeferred() {
+    int destroyed = 0;
+
+    struct SNode {
+        SNode(int& destroyed) : destroyed(destroyed) {
+            ;
+        }
+
+        ~SNode() {
+            destroyed++;
+        }
+
+        int&      destroyed;
+        SP<SNode> child;
+    };
+
+    { // without a reclaimer, nothing changes
+        auto node = makeShared<SNode>(destroyed);
+        deferDestruction(node);
+        node.reset();
+        EXPECT_EQ(destroyed, 1);
+    }
+
+    destroyed = 0;
+
+    {
+        CDeferredReclaimer reclaimer;
+        EXPECT_EQ(CDeferredReclaimer::current(), &reclaimer);
+
+        auto node   = makeShared<SNode>(destroyed);
+        node->child = makeShared<SNode>(destroyed);
+
+        WP<SNode> weak  = node;
+        WP<SNode> child = node->child;
+        deferDestruction(node);
+        deferDestruction(node->child);
+
+        auto plain = makeShared<SNode>(destroyed);
+        plain.reset();
+        EXPECT_EQ(destroyed, 1);
+
+        node.reset();
+        EXPECT_EQ(destroyed, 1);
+        EXPECT_EQ(reclaimer.pending(), 1);
+        EXPECT_EQ(weak.expired(), true);
+        EXPECT_EQ(!!weak.lock(), false);
+        EXPECT_EQ(weak.valid(), false);
+        EXPECT_EQ(!!weak, false);
+        EXPECT_EQ(weak.get(), nullptr);
+        EXPECT_EQ(child.expired(), false);
+        EXPECT_EQ(!!child, true);
+
+        // the child gets queued by the parent's destructor and is destroyed in the same drain
+        EXPECT_EQ(reclaimer.drain(), 2);
+        EXPECT_EQ(destroyed, 3);
+        EXPECT_EQ(reclaimer.pending(), 0);
+        EXPECT_EQ(weak.get(), nullptr);
+        EXPECT_EQ(child.expired(), true);
+
+        // a budget always lets at least one through
+        for (int i = 0; i < 10; i++) {
+            auto n = makeShared<SNode>(destroyed);
+            deferDestruction(n);
+        }
+
+        EXPECT_EQ(reclaimer.pending(), 10);
+        EXPECT_GE(reclaimer.drain(std::chrono::nanoseconds(0)), 1);
+        EXPECT_LE(reclaimer.pending(), 9);
+
+        // the rest goes with the reclaimer
+    }
+
+    EXPECT_EQ(destroyed, 13);
+    EXPECT_EQ(CDeferredReclaimer::current(), nullptr);
+}
+
+static void testAllocated() {
+    CFrameArena arena(1024);
+
+    int destroyed = 0;
+
+    struct SRecord {
+        SRecord(int& destroyed, int value) : destroyed(destroyed), value(value) {
+            ;
+        }
+
+        ~SRecord() {
+            destroyed++;
+        }
+
+        int& destroyed;
+        int  value = 0;
+    };
+
+    void* first = nullptr;
+
+    for (int frame = 0; frame < 3; frame++) {
+        {
+            auto        shared = allocateShared<SRecord>(&arena, destroyed, 1);
+            auto        unique = allocateUnique<SRecord>(&arena, destroyed, 2);
+            WP<SRecord> weak   = shared;
+            WP<SRecord> weakU  = unique;
+
+            EXPECT_EQ(shared->value, 1);
+            EXPECT_EQ(unique->value, 2);
+            EXPECT_EQ(shared.impl_->fused(), true);
+            EXPECT_EQ(!!weakU.lock(), false);
+            EXPECT_EQ(arena.live(), 2);
+
+            if (frame == 0)
+                first = shared.get();
+            else // same memory every frame
+                EXPECT_EQ(shared.get(), first);
+
+            // lots of small objects, spilling into more chunks
+            std::vector<SP<SRecord>> records;
+            for (int i = 0; i < 100; i++) {
+                records.emplace_back(allocateShared<SRecord>(&arena, destroyed, i));
+            }
+
+            shared.reset();
+            EXPECT_EQ(weak.expired(), true);
+            EXPECT_EQ(arena.live(), 102);
+        }
+
+        EXPECT_EQ(arena.live(), 0);
+        arena.reset();
+        EXPECT_EQ(arena.used(), 0);
+    }
+
+    EXPECT_EQ(destroyed, 3 * 102);
+
+    const auto CAPACITY = arena.capacity();
+    arena.trim();
+    EXPECT_LT(arena.capacity(), CAPACITY);
+
+    // works with any resource
+    std::pmr::monotonic_buffer_resource monotonic;
+    auto                                ptr = allocateShared<int>(&monotonic, 5);
+    EXPECT_EQ(*ptr, 5);
+}
+
+class CSelfRef : public CSelfReferencing<CSelfRef> {
+  public:
+    CSelfRef(WP<CSelfRef>& seen) : seenInDestructor(seen) {
+        seenInConstructor = self();
+    }
+
+    virtual ~CSelfRef() {
+        seenInDestructor = self();
+    }
+
+    WP<CSelfRef>  seenInConstructor;
+    WP<CSelfRef>& seenInDestructor;
+};
+
+class CSelfRefChild : public CSelfRef {
+  public:
+    CSelfRefChild(WP<CSelfRef>& seen) : CSelfRef(seen) {
+        ;
+    }
+
+    int value = 42;
+};
+
+class CSelfRefEarly : public CSelfReferencing<CSelfRefEarly> {
+  public:
+    CSelfRefEarly(WP<CSelfRefEarly>& outside, bool fail) {
+        // no strong ref while being constructed, it would free the object once dropped
+        sharedInConstructor = !!sharedSelf() || !!self().lock();
+        seen                = self();
+        outside             = self();
+
+        if (fail)
+            throw std::runtime_error("constructor failed");
+    }
+
+    bool              sharedInConstructor = true;
+    WP<CSelfRefEarly> seen;
+};
+
+static void testSelfReferencing() {
+    CFrameArena  arena;
+    WP<CSelfRef> seen;
+
+    {
+        auto shared = makeShared<CSelfRef>(seen);
+        EXPECT_EQ(sizeof(CSelfRef), sizeof(void*) * 3);
+        EXPECT_EQ(shared->self(), shared);
+        EXPECT_EQ(shared->seenInConstructor, shared);
+        EXPECT_EQ(shared->sharedSelf(), shared);
+        EXPECT_EQ(shared.strongRef(), 1);
+    }
+
+    // the block stays around for the weak ref taken in the destructor
+    EXPECT_EQ(seen.expired(), true);
+    seen.reset();
+
+    {
+        SP<CSelfRef> child = makeShared<CSelfRefChild>(seen);
+        EXPECT_EQ(child->self(), child);
+        EXPECT_EQ(rc<CSelfRefChild*>(child->sharedSelf().get())->value, 42);
+
+        auto unique = makeUnique<CSelfRef>(seen);
+        EXPECT_EQ(unique->self(), unique);
+        EXPECT_EQ(!!unique->sharedSelf(), false);
+
+        auto allocated = allocateShared<CSelfRef>(&arena, seen);
+        EXPECT_EQ(allocated->self(), allocated);
+    }
+
+    seen.reset();
+
+    {
+        WP<CSelfRefEarly> outside;
+        auto              early = makeShared<CSelfRefEarly>(outside, false);
+        EXPECT_EQ(early->sharedInConstructor, false);
+        EXPECT_EQ(early->sharedSelf(), early);
+        EXPECT_EQ(early.strongRef(), 1);
+
+        // the weak refs the constructor took keep the block, the outside one frees it
+        EXPECT_THROW(makeShared<CSelfRefEarly>(outside, true), std::runtime_error);
+        EXPECT_EQ(outside.expired(), true);
+        EXPECT_EQ(outside.valid(), false);
+        outside.reset();
+
+        EXPECT_THROW(allocateShared<CSelfRefEarly>(&arena, outside, true), std::runtime_error);
+        EXPECT_EQ(outside.expired(), true);
+    }
+
+    EXPECT_THROW(CSelfRef onStack(seen), std::logic_error);
+    EXPECT_THROW(SP<CSelfRef>(new CSelfRef(seen)), std::logic_error);
+}
+
+static void testInstrumentation() {
+    if constexpr (!Impl_::INSTRUMENTED)
+        return;
+
+    struct STracked {
+        int a = 0;
+    };
+
+    const auto find = [](const SMemorySnapshot& snapshot) {
+        const auto IT = std::ranges::find_if(snapshot.types, [](const auto& t) { return t.type.contains("STracked"); });
+        return IT == snapshot.types.end() ? SMemoryTypeStats{} : *IT;
+    };
+
+    {
+        auto         shared = makeShared<STracked>();
+        auto         unique = makeUnique<STracked>();
+        SP<STracked> separate(new STracked());
+        WP<STracked> zombie = makeShared<STracked>();
+
+        auto stats = find(getMemorySnapshot());
+        EXPECT_EQ(stats.live, 4);
+        EXPECT_EQ(stats.peak, 4);
+        EXPECT_EQ(stats.total, 4);
+        EXPECT_EQ(stats.zombies, 1);
+        EXPECT_GE(getMemorySnapshot().sizes[2], 4);
+        EXPECT_EQ(dumpMemorySnapshot(getMemorySnapshot()).contains("STracked"), true);
+    }
+
+    const auto stats = find(getMemorySnapshot());
+    EXPECT_EQ(stats.live, 0);
+    EXPECT_EQ(stats.peak, 4);
+    EXPECT_EQ(stats.zombies, 0);
+}
+
+static void testControlBlockPool() {
+    const auto before = getControlBlockPoolStats();
+    if (!before.enabled)
+        return;
+
+    {
+        std::vector<SP<int>> ptrs;
+        for (size_t i = 0; i < 1000; i++) {
+            ptrs.emplace_back(SP<int>(new int(i)));
+        }
+
+        // recycled blocks have to come back usable
+        ptrs.clear();
+        for (size_t i = 0; i < 1000; i++) {
+            ptrs.emplace_back(SP<int>(new int(i)));
+            EXPECT_EQ(*ptrs.back(), (int)i);
+            EXPECT_EQ(ptrs.back().strongRef(), 1);
+        }
+    }
+
+    const auto after = getControlBlockPoolStats();
+    EXPECT_GE(after.hits + after.misses - before.hits - before.misses, 2000);
+    EXPECT_GE(after.hits - before.hits, 1000);
+    EXPECT_GE(after.slabs, 1);
+
+    // blocks freed by a thread that already exited are not lost
+    std::thread([] {
+        for (size_t i = 0; i < 1000; i++) {
+            SP<int> ptr(new int(i));
+        }
+    }).join();
+
+    EXPECT_GE(getControlBlockPoolStats().hits, after.hits + 999);
+}
+
 TEST(Memory, memory) {
     SP<int> intPtr    = makeShared<int>(10);
     SP<int> intPtr2   = makeShared<int>(-1337);
@@ -176,4 +738,13 @@ TEST(Memory, memory) {
     EXPECT_EQ(*intPtr2, 10);
 
     testAtomicImpl();
+    testFused();
+    testAtomicSlot();
+    testBiased();
+    testCompactBlock();
+    testDeferred();
+    testAllocated();
+    testSelfReferencing();
+    testInstrumentation();
+    testControlBlockPool();
 }
@@ -0,0 +1,162 @@
+#include <hyprutils/memory/ObjectPool.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+static std::atomic<int> g_constructed = 0;
+static std::atomic<int> g_destroyed   = 0;
+
+struct SElement {
+    SElement(int v = 0) : value(v) {
+        g_constructed++;
+    }
+
+    ~SElement() {
+        g_destroyed++;
+    }
+
+    int value = 0;
+};
+
+static void testReset() {
+    g_constructed = 0;
+    g_destroyed   = 0;
+
+    {
+        CObjectPool<SElement> pool;
+
+        auto                   a    = pool.acquire(1);
+        const auto             ADDR = a.get();
+        CWeakPointer<SElement> weak = a;
+        EXPECT_EQ(pool.outstanding(), 1);
+
+        a.reset();
+        EXPECT_EQ(g_destroyed, 1);
+        EXPECT_EQ(pool.idle(), 1);
+        EXPECT_EQ(pool.outstanding(), 0);
+        EXPECT_TRUE(weak.expired());
+
+        // same storage, freshly constructed, and the old weak pointer doesn't see it
+        auto b = pool.acquire(2);
+        EXPECT_EQ(b.get(), ADDR);
+        EXPECT_EQ(b->value, 2);
+        EXPECT_EQ(g_constructed, 2);
+        EXPECT_TRUE(weak.expired());
+        EXPECT_EQ(weak.get(), nullptr);
+
+        CWeakPointer<SElement> weakB = b;
+        EXPECT_FALSE(weakB.expired());
+        EXPECT_EQ(weakB->value, 2);
+    }
+
+    EXPECT_EQ(g_constructed, g_destroyed);
+}
+
+static void testKeepState() {
+    g_constructed = 0;
+    g_destroyed   = 0;
+
+    {
+        CObjectPool<SElement> pool({.resetOnReturn = false, .maxIdle = 2});
+
+        auto a   = pool.acquire(1);
+        a->value = 5;
+        a.reset();
+        EXPECT_EQ(g_destroyed, 0);
+
+        // the idle object comes back as it was, args are only used for new ones
+        a = pool.acquire(1);
+        EXPECT_EQ(a->value, 5);
+        EXPECT_EQ(g_constructed, 1);
+
+        std::vector<CUniquePointer<SElement>> elements;
+        for (int i = 0; i < 4; ++i) {
+            elements.emplace_back(pool.acquire(i));
+        }
+        elements.clear();
+
+        // only two are kept
+        EXPECT_EQ(pool.idle(), 2);
+        EXPECT_EQ(g_destroyed, 2);
+
+        pool.trim();
+        EXPECT_EQ(pool.idle(), 0);
+        EXPECT_EQ(g_destroyed, 4);
+    }
+
+    EXPECT_EQ(g_constructed, g_destroyed);
+}
+
+static void testOutlive() {
+    g_constructed = 0;
+    g_destroyed   = 0;
+
+    CUniquePointer<SElement> survivor;
+    CWeakPointer<SElement>   weak;
+
+    {
+        CObjectPool<SElement> pool({.resetOnReturn = false});
+        survivor = pool.acquire(7);
+        weak     = survivor;
+        pool.acquire(8).reset();
+    }
+
+    EXPECT_EQ(g_destroyed, 1);
+    EXPECT_EQ(survivor->value, 7);
+
+    survivor.reset();
+    EXPECT_EQ(g_destroyed, 2);
+    EXPECT_TRUE(weak.expired());
+}
+
+static void testThreads() {
+    g_constructed = 0;
+    g_destroyed   = 0;
+
+    {
+        CObjectPool<SElement>    pool({.threadSafe = true});
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&pool] {
+                for (int i = 0; i < 1000; ++i) {
+                    auto e = pool.acquire(i);
+                    EXPECT_EQ(e->value, i);
+                }
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        EXPECT_EQ(pool.outstanding(), 0);
+        EXPECT_LE(pool.idle(), 4);
+    }
+
+    EXPECT_EQ(g_constructed, g_destroyed);
+}
+
+static void testLocal() {
+    auto&      pool = CObjectPool<SElement>::local();
+    const auto IDLE = pool.idle();
+
+    pool.acquire(1).reset();
+    EXPECT_EQ(pool.idle(), std::max<size_t>(IDLE, 1));
+
+    std::thread([&pool] { EXPECT_NE(&CObjectPool<SElement>::local(), &pool); }).join();
+}
+
+TEST(Memory, objectPool) {
+    testReset();
+    testKeepState();
+    testOutlive();
+    testThreads();
+    testLocal();
+}
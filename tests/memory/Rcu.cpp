@@ -0,0 +1,156 @@
+#include <hyprutils/memory/Rcu.hpp>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Hyprutils::Memory;
+
+struct SConfig {
+    SConfig() = default;
+
+    SConfig(const SConfig& other) : a(other.a), b(other.b), alive(other.alive) {
+        if (alive)
+            (*alive)++;
+    }
+
+    SConfig(int a_, int b_, std::atomic<int>& alive_) : a(a_), b(b_), alive(&alive_) {
+        alive_++;
+    }
+
+    ~SConfig() {
+        if (alive)
+            (*alive)--;
+    }
+
+    // readers check a == b, writers keep it that way
+    int               a     = 0;
+    int               b     = 0;
+    std::atomic<int>* alive = nullptr;
+};
+
+static void testSingleThread() {
+    std::atomic<int> alive = 0;
+
+    {
+        CRcuPointer<SConfig> config(new SConfig(1, 1, alive));
+
+        {
+            CRcuReadGuard guard;
+            EXPECT_EQ(config.read()->a, 1);
+
+            // nested sections are fine, blocking on a grace period inside one is not
+            CRcuReadGuard nested;
+            EXPECT_THROW(rcuSynchronize(), std::logic_error);
+
+            // so a synchronous update throws before publishing, and frees what it was given
+            EXPECT_THROW(config.update(new SConfig(5, 5, alive)), std::logic_error);
+            EXPECT_THROW(config.modify([](SConfig& c) { c.a = c.b = 5; }), std::logic_error);
+            EXPECT_EQ(config.read()->a, 1);
+            EXPECT_EQ(alive, 1);
+        }
+
+        // a throwing fn publishes nothing and leaks nothing
+        const auto BEFORE = config.read();
+        EXPECT_THROW(config.modify([](SConfig&) { throw std::runtime_error("fn"); }), std::runtime_error);
+        EXPECT_EQ(config.read(), BEFORE);
+        EXPECT_EQ(alive, 1);
+        EXPECT_EQ(rcuPending(), 0);
+
+        config.modify([](SConfig& c) { c.a = c.b = 2; });
+        EXPECT_EQ(alive, 1);
+
+        {
+            CRcuReadGuard guard;
+            EXPECT_EQ(config.read()->a, 2);
+
+            // the reader may still hold the old version, so deferring keeps it around
+            const auto OLD = config.read();
+            config.modify([](SConfig& c) { c.a = c.b = 3; }, RCU_DEFER);
+            EXPECT_EQ(OLD->a, 2);
+            EXPECT_EQ(rcuReclaim(), 0);
+            EXPECT_EQ(alive, 2);
+        }
+
+        EXPECT_EQ(rcuReclaim(), 1);
+        EXPECT_EQ(alive, 1);
+
+        config.emplace(RCU_DEFER, 4, 4, alive);
+        EXPECT_EQ(alive, 2);
+        rcuSynchronize();
+        EXPECT_EQ(rcuPending(), 0);
+        EXPECT_EQ(alive, 1);
+    }
+
+    EXPECT_EQ(alive, 0);
+}
+
+static void testThreads() {
+    std::atomic<int>         alive = 0;
+    std::atomic<bool>        done  = false;
+    CRcuPointer<SConfig>     config(new SConfig(0, 0, alive));
+    std::vector<std::thread> readers;
+
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            int last = 0;
+            while (!done) {
+                CRcuReadGuard guard;
+                const auto    CONFIG = config.read();
+                EXPECT_EQ(CONFIG->a, CONFIG->b);
+                EXPECT_GE(CONFIG->a, last);
+                last = CONFIG->a;
+            }
+        });
+    }
+
+    for (int i = 1; i <= 200; i++) {
+        config.modify([i](SConfig& c) { c.a = c.b = i; }, i % 2 ? RCU_DEFER : RCU_SYNCHRONIZE);
+    }
+
+    done = true;
+    for (auto& r : readers) {
+        r.join();
+    }
+
+    rcuSynchronize();
+    EXPECT_EQ(alive, 1);
+}
+
+static void testDeferInsideSection() {
+    std::atomic<int>             alive   = 0;
+    std::atomic<bool>            waiting = false;
+    CRcuPointer<SConfig>         config(new SConfig(0, 0, alive));
+    std::optional<CRcuReadGuard> guard;
+
+    guard.emplace();
+
+    // a grace period waits on this section, while enough deferred updates pile up to reclaim on their own
+    std::thread synchronizer([&] {
+        waiting = true;
+        rcuSynchronize();
+    });
+
+    while (!waiting) {
+        std::this_thread::yield();
+    }
+
+    for (int i = 1; i <= 100; i++) {
+        config.modify([i](SConfig& c) { c.a = c.b = i; }, RCU_DEFER);
+    }
+
+    guard.reset();
+    synchronizer.join();
+
+    rcuSynchronize();
+    EXPECT_EQ(alive, 1);
+}
+
+TEST(Memory, rcu) {
+    testSingleThread();
+    testThreads();
+    testDeferInsideSection();
+}
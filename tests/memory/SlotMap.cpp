@@ -0,0 +1,134 @@
+#include <hyprutils/memory/SlotMap.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace Hyprutils::Memory;
+
+static void testHandles() {
+    CSlotMap<std::string> map;
+
+    auto a = map.insert("a");
+    auto b = map.emplace("b");
+    auto c = map.emplace(3, 'c');
+
+    EXPECT_EQ(map.size(), 3);
+    EXPECT_EQ(*map.get(a), "a");
+    EXPECT_EQ(*map.get(b), "b");
+    EXPECT_EQ(*map.get(c), "ccc");
+
+    // erasing moves the last value, the handles still find theirs
+    EXPECT_EQ(map.erase(a), true);
+    EXPECT_EQ(map.erase(a), false);
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_EQ(map.contains(a), false);
+    EXPECT_EQ(*map.get(b), "b");
+    EXPECT_EQ(*map.get(c), "ccc");
+    EXPECT_EQ(map.size(), 2);
+
+    // the slot gets reused, but the old handle stays stale
+    auto d = map.insert("d");
+    EXPECT_EQ(d.index, a.index);
+    EXPECT_NE(d.generation, a.generation);
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_EQ(*map.get(d), "d");
+
+    EXPECT_EQ(map.get(SSlotHandle{}), nullptr);
+    EXPECT_EQ(map.get(SSlotHandle{.index = 100, .generation = 1}), nullptr);
+
+    for (size_t i = 0; i < map.size(); ++i) {
+        EXPECT_EQ(map.get(map.handleAt(i)), map.data() + i);
+    }
+
+    map.clear();
+    EXPECT_EQ(map.empty(), true);
+    EXPECT_EQ(map.contains(b), false);
+    EXPECT_EQ(map.contains(d), false);
+}
+
+static void testIteration() {
+    CSlotMap<int>            map;
+    std::vector<SSlotHandle> handles;
+
+    for (int i = 0; i < 100; i++) {
+        handles.emplace_back(map.insert(i));
+    }
+
+    EXPECT_EQ(map.eraseIf([](int v) { return v % 2; }), 50);
+    EXPECT_EQ(map.size(), 50);
+
+    int sum = 0;
+    for (const auto& v : map) {
+        EXPECT_EQ(v % 2, 0);
+        sum += v;
+    }
+    EXPECT_EQ(sum, 2450);
+
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(map.contains(handles[i]), i % 2 == 0);
+        if (i % 2 == 0) {
+            EXPECT_EQ(*map.get(handles[i]), i);
+        }
+    }
+
+    // erase while iterating
+    for (auto it = map.begin(); it != map.end();) {
+        if (*it % 4 == 0)
+            it = map.erase(it);
+        else
+            ++it;
+    }
+
+    EXPECT_EQ(map.size(), 25);
+    EXPECT_EQ(std::ranges::all_of(map, [](int v) { return v % 4 == 2; }), true);
+}
+
+static void testValues() {
+    // values are destroyed when erased, not when the slot is reused
+    CSlotMap<CSharedPointer<int>> map;
+    auto                          value = makeShared<int>(1);
+
+    auto handle = map.insert(value);
+    map.insert(makeShared<int>(2));
+    EXPECT_EQ(value.strongRef(), 2);
+
+    map.erase(handle);
+    EXPECT_EQ(value.strongRef(), 1);
+    EXPECT_EQ(**map.begin(), 2);
+}
+
+static void testThrowing() {
+    struct SPicky {
+        SPicky(bool fail) {
+            if (fail)
+                throw std::runtime_error("no");
+        }
+    };
+
+    // a throwing constructor gives the slot back, whether it was fresh or reused
+    CSlotMap<SPicky> map;
+    auto             first = map.emplace(false);
+
+    EXPECT_THROW(map.emplace(true), std::runtime_error);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.emplace(false).index, 1);
+
+    map.erase(first);
+    EXPECT_THROW(map.emplace(true), std::runtime_error);
+    EXPECT_EQ(map.size(), 1);
+    EXPECT_EQ(map.contains(first), false);
+
+    const auto REUSED = map.emplace(false);
+    EXPECT_EQ(REUSED.index, first.index);
+    EXPECT_NE(REUSED.generation, first.generation);
+}
+
+TEST(Memory, slotMap) {
+    testHandles();
+    testIteration();
+    testValues();
+    testThrowing();
+}
@@ -1,11 +1,20 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <any>
+#include <chrono>
 #include <hyprutils/signal/Signal.hpp>
 #include <hyprutils/signal/Listener.hpp>
+#include <hyprutils/signal/Instrumentation.hpp>
 #include <hyprutils/memory/WeakPtr.hpp>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <poll.h>
 
 using namespace Hyprutils::Signal;
 using namespace Hyprutils::Memory;
@@ -344,6 +353,565 @@ static void listenerDestroysSelf() {
     signal.emit();
 }
 
+static void nestedEmit() {
+    int                 count = 0;
+    int                 depth = 0;
+
+    CSignalT<>          signal;
+    CHyprSignalListener removed;
+
+    auto                listener = signal.listen([&] {
+        count += 1;
+
+        // the inner emit removes a listener the outer one didn't reach yet
+        if (depth++ == 0) {
+            signal.emit();
+            removed.reset();
+        }
+    });
+
+    removed = signal.listen([&] { count += 10; });
+
+    signal.emit();
+    EXPECT_EQ(count, 12); // outer, inner, removed from the inner emit only
+
+    count = 0;
+    signal.emit();
+    EXPECT_EQ(count, 1);
+}
+
+// purely an asan test
+static void signalDestroyedInNestedEmit() {
+    int  count = 0;
+    bool inner = false;
+
+    auto signal = std::make_unique<CSignalT<>>();
+
+    auto listener = signal->listen([&] {
+        if (!inner) {
+            inner = true;
+            signal->emit();
+        } else
+            signal.reset();
+    });
+
+    auto after = signal->listen([&] { count += 1; });
+
+    signal->emit();
+    EXPECT_EQ(count, 2); // both emits finish with the listeners they started with
+}
+
+static void signalMoved() {
+    struct SHolder {
+        CSignalT<int> sig;
+    };
+
+    int  count = 0;
+
+    auto a        = std::make_unique<SHolder>();
+    auto listener = a->sig.listen([&](int v) { count += v; });
+    a->sig.listenStatic([&](int v) { count += 10 * v; });
+
+    // moving takes every listener along
+    SHolder b = std::move(*a);
+    a.reset();
+    b.sig.emit(1);
+    EXPECT_EQ(count, 11);
+
+    // assigning drops the listeners the target had
+    count = 0;
+    CSignalT<int> c;
+    auto          dropped = c.listen([&](int v) { count += 100 * v; });
+    c                     = std::move(b.sig);
+    c.emit(1);
+    EXPECT_EQ(count, 11);
+
+    // removing a listener still works after the move
+    count = 0;
+    listener.reset();
+    c.emit(1);
+    EXPECT_EQ(count, 10);
+}
+
+static void signalMovedInEmit() {
+    int                         count = 0;
+    std::unique_ptr<CSignalT<>> moved;
+
+    auto                        signal = std::make_unique<CSignalT<>>();
+    auto                        first  = signal->listen([&] {
+        count += 1;
+        if (!moved) {
+            moved = std::make_unique<CSignalT<>>(std::move(*signal));
+            signal.reset();
+        }
+    });
+    auto                        second = signal->listen([&] { count += 10; });
+
+    // the emit goes on with the signal it was moved to
+    signal->emit();
+    EXPECT_EQ(count, 11);
+
+    count = 0;
+    moved->emit();
+    EXPECT_EQ(count, 11);
+}
+
+static void signalNotCopyable() {
+    // a listener belongs to one signal, so a copy couldn't fire the listeners of the original
+    static_assert(!std::is_copy_constructible_v<CSignalT<int>> && !std::is_copy_assignable_v<CSignalT<int>>);
+    static_assert(std::is_nothrow_move_constructible_v<CSignalT<int>> && std::is_nothrow_move_assignable_v<CSignalT<int>>);
+    static_assert(!std::is_copy_constructible_v<CSignal>);
+}
+
+static void keyed() {
+    int                          count = 0;
+
+    CKeyedSignalT<uint32_t, int> signal;
+    auto                         l1 = signal.listen(1, [&](int v) { count += v; });
+    auto                         l2 = signal.listen(2, [&](int v) { count += v * 10; });
+    auto                         l3 = signal.listen(2, [&] { count += 100; });
+
+    signal.emit(1, 1);
+    EXPECT_EQ(count, 1);
+
+    signal.emit(2, 1);
+    EXPECT_EQ(count, 111);
+
+    // nobody listens to 3
+    signal.emit(3, 1);
+    EXPECT_EQ(count, 111);
+    EXPECT_FALSE(signal.hasListeners(3));
+
+    l2.reset();
+    l3.reset();
+    EXPECT_FALSE(signal.hasListeners(2));
+    signal.emit(2, 1);
+    EXPECT_EQ(count, 111);
+    EXPECT_TRUE(signal.hasListeners(1));
+}
+
+static void keyedChurn() {
+    int                              count = 0;
+
+    CKeyedSignalT<uint32_t>          signal;
+    std::vector<CHyprSignalListener> kept;
+
+    // keys nobody listens to anymore get dropped, while listening to new ones in handlers is fine
+    for (uint32_t i = 0; i < 1000; ++i) {
+        auto listener = signal.listen(i, [&, i] {
+            count += 1;
+            kept.emplace_back(signal.listen(i + 100000, [&] { count += 10; }));
+        });
+
+        signal.emit(i);
+        signal.emit(i + 100000);
+    }
+
+    EXPECT_EQ(count, 11000);
+    EXPECT_TRUE(signal.hasListeners(100999));
+    EXPECT_FALSE(signal.hasListeners(999));
+}
+
+static void deferred() {
+    std::vector<int>      seen;
+
+    CDeferredSignalT<int> all;
+    CDeferredSignalT<int> last(DEFER_KEEP_LAST);
+    CDeferredSignalT<int> sum([](std::tuple<int>& pending, std::tuple<int>&& incoming) { std::get<0>(pending) += std::get<0>(incoming); });
+
+    auto                  l1 = all.listen([&](int v) { seen.push_back(v); });
+    auto                  l2 = last.listen([&](int v) { seen.push_back(v * 10); });
+    auto                  l3 = sum.listen([&](int v) { seen.push_back(v * 100); });
+
+    for (int i = 1; i <= 3; ++i) {
+        all.emit(i);
+        last.emit(i);
+        sum.emit(i);
+    }
+
+    // nothing is dispatched until the flush
+    EXPECT_TRUE(seen.empty());
+    EXPECT_EQ(all.pending(), 3);
+    EXPECT_EQ(last.pending(), 1);
+    EXPECT_EQ(sum.pending(), 1);
+
+    all.flush();
+    last.flush();
+    sum.flush();
+    EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 30, 600}));
+    EXPECT_EQ(all.pending(), 0);
+
+    // flushing an empty queue does nothing
+    seen.clear();
+    all.flush();
+    EXPECT_TRUE(seen.empty());
+
+    all.emit(1);
+    all.discard();
+    all.flush();
+    EXPECT_TRUE(seen.empty());
+}
+
+static void deferredReentrant() {
+    int                           count = 0;
+
+    CDeferredSignalT<std::string> signal;
+
+    // arguments are copied, the original may be gone by the flush
+    {
+        std::string text = "hello";
+        signal.emit(text);
+    }
+
+    auto listener = signal.listen([&](const std::string& text) {
+        EXPECT_EQ(text, "hello");
+        count += 1;
+
+        // events emitted during a flush wait for the next one
+        signal.emit(text);
+        signal.flush();
+    });
+
+    signal.flush();
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(signal.pending(), 1);
+
+    signal.flush();
+    EXPECT_EQ(count, 2);
+}
+
+// purely an asan test
+static void deferredDestroyedInFlush() {
+    int  count  = 0;
+    auto signal = std::make_unique<CDeferredSignalT<>>();
+
+    auto listener = signal->listen([&] {
+        count += 1;
+        signal.reset();
+    });
+
+    signal->emit();
+    signal->emit();
+    signal->flush();
+    EXPECT_EQ(count, 1);
+}
+
+static void deferredThrowing() {
+    int                   seen = 0;
+
+    CDeferredSignalT<int> signal;
+    auto                  listener = signal.listen([&](int v) {
+        if (v < 0)
+            throw std::runtime_error("bad event");
+        seen = v;
+    });
+
+    // the events queued after the throwing one are lost, but the next flush works
+    signal.emit(-1);
+    signal.emit(1);
+    EXPECT_THROW(signal.flush(), std::runtime_error);
+    EXPECT_EQ(seen, 0);
+
+    signal.emit(2);
+    signal.flush();
+    EXPECT_EQ(seen, 2);
+}
+
+static void crossThread() {
+    constexpr int            THREADS = 4;
+    constexpr int            EMITS   = 10000;
+
+    CCrossThreadSignalT<int> signal;
+    int                      sum      = 0;
+    int                      received = 0;
+    std::thread::id          dispatchedOn;
+
+    auto                     listener = signal.listen([&](int v) {
+        sum += v;
+        received++;
+        dispatchedOn = std::this_thread::get_id();
+    });
+
+    // nothing to do yet
+    EXPECT_FALSE(signal.getFD().isReadable());
+    signal.dispatchPending();
+    EXPECT_EQ(received, 0);
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; ++t) {
+        producers.emplace_back([&signal] {
+            for (int i = 0; i < EMITS; ++i) {
+                signal.emitFromAnyThread(1);
+            }
+        });
+    }
+
+    // the owner's event loop
+    pollfd pfd = {.fd = signal.getFD().get(), .events = POLLIN, .revents = 0};
+    while (received < THREADS * EMITS) {
+        ASSERT_GT(poll(&pfd, 1, 5000), 0);
+        signal.dispatchPending();
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    // a wakeup can outlive the events it was for, dispatching then does nothing
+    signal.dispatchPending();
+    EXPECT_FALSE(signal.getFD().isReadable());
+
+    EXPECT_EQ(sum, THREADS * EMITS);
+    EXPECT_EQ(dispatchedOn, std::this_thread::get_id());
+}
+
+static void crossThreadOwner() {
+    int count = 0;
+
+    // events left in the queue are released with the signal
+    auto signal = std::make_unique<CCrossThreadSignalT<std::string>>();
+    signal->emitFromAnyThread("dropped");
+    signal.reset();
+
+    // purely an asan test
+    signal        = std::make_unique<CCrossThreadSignalT<std::string>>();
+    auto listener = signal->listen([&](const std::string& text) {
+        count += 1;
+        signal.reset();
+    });
+
+    std::thread([&signal] {
+        signal->emitFromAnyThread("a");
+        signal->emitFromAnyThread("b");
+    }).join();
+
+    EXPECT_TRUE(signal->getFD().isReadable());
+    signal->dispatchPending();
+    EXPECT_EQ(count, 1);
+}
+
+static void crossThreadThrowing() {
+    int                      seen = 0;
+
+    CCrossThreadSignalT<int> signal;
+    auto                     listener = signal.listen([&](int v) {
+        if (v < 0)
+            throw std::runtime_error("bad event");
+        seen = v;
+    });
+
+    // the events after the throwing one stay queued for the next dispatch
+    signal.emitFromAnyThread(-1);
+    signal.emitFromAnyThread(1);
+    EXPECT_THROW(signal.dispatchPending(), std::runtime_error);
+    EXPECT_EQ(seen, 0);
+
+    signal.dispatchPending();
+    EXPECT_EQ(seen, 1);
+}
+
+static void memberListener() {
+    struct SOwner {
+        int value = 0;
+        int calls = 0;
+
+        void onValue(int v) {
+            value += v;
+        }
+
+        void onAny() {
+            calls++;
+        }
+
+        void peek(int v) const {
+            ;
+        }
+    };
+
+    CSignalT<int> signal;
+
+    auto          owner  = makeShared<SOwner>();
+    auto          unique = makeUnique<SOwner>();
+    signal.listen(CWeakPointer<SOwner>(owner), &SOwner::onValue);
+    signal.listen(CWeakPointer<SOwner>(owner), &SOwner::onAny);
+    signal.listen(CWeakPointer<SOwner>(owner), &SOwner::peek);
+    signal.listen(CWeakPointer<SOwner>(unique), &SOwner::onValue);
+
+    signal.emit(2);
+    EXPECT_EQ(owner->value, 2);
+    EXPECT_EQ(owner->calls, 1);
+    EXPECT_EQ(unique->value, 2);
+
+    // expired owners are skipped and dropped, the signal doesn't keep them alive
+    CWeakPointer<SOwner> weak = owner;
+    owner.reset();
+    EXPECT_FALSE(weak.valid());
+    signal.emit(2);
+    EXPECT_EQ(unique->value, 4);
+
+    unique.reset();
+    signal.emit(2);
+
+    // owners that are already gone are not registered
+    signal.listen(CWeakPointer<SOwner>(), &SOwner::onAny);
+    signal.emit(2);
+}
+
+static void memberListenerInEmit() {
+    struct SOwner {
+        CSignalT<>*             signal = nullptr;
+        std::vector<int>        seen;
+        CSharedPointer<SOwner>* holder = nullptr;
+        CSharedPointer<SOwner>  other;
+
+        void onEmit() {
+            seen.push_back(1);
+
+            // grows the signal's storage while being called from it
+            for (int i = 0; i < 64; ++i) {
+                signal->listen(CWeakPointer<SOwner>(other), &SOwner::onLate);
+            }
+
+            // and destroys itself
+            holder->reset();
+        }
+
+        void onLate() {
+            seen.push_back(2);
+        }
+    };
+
+    CSignalT<>           signal;
+
+    auto                 other = makeShared<SOwner>();
+    auto                 owner = makeShared<SOwner>();
+    CWeakPointer<SOwner> weak  = owner;
+    owner->signal              = &signal;
+    owner->holder              = &owner;
+    owner->other               = other;
+
+    signal.listen(weak, &SOwner::onEmit);
+
+    // listeners added during an emit wait for the next one
+    signal.emit();
+    EXPECT_FALSE(weak.valid());
+    EXPECT_TRUE(other->seen.empty());
+
+    signal.emit();
+    EXPECT_EQ(other->seen.size(), 64);
+}
+
+static void priority() {
+    std::vector<int> order;
+
+    CSignalT<>       signal;
+    auto             l1 = signal.listen([&] { order.push_back(1); });
+    auto             l2 = signal.listen([&] { order.push_back(2); }, 10);
+    auto             l3 = signal.listen([&] { order.push_back(3); }, -5);
+    auto             l4 = signal.listen([&] { order.push_back(4); }, 10);
+    auto             l5 = signal.listen([&] { order.push_back(5); });
+
+    signal.emit();
+    EXPECT_EQ(order, (std::vector<int>{2, 4, 1, 5, 3}));
+
+    // a listener added in front during an emit waits for the next one
+    CHyprSignalListener added;
+    auto                adder = signal.listen(
+        [&] {
+            if (!added)
+                added = signal.listen([&] { order.push_back(6); }, 100);
+        },
+        -10);
+
+    order.clear();
+    signal.emit();
+    EXPECT_EQ(order, (std::vector<int>{2, 4, 1, 5, 3}));
+
+    order.clear();
+    signal.emit();
+    EXPECT_EQ(order, (std::vector<int>{6, 2, 4, 1, 5, 3}));
+}
+
+static void consumable() {
+    std::vector<int> order;
+
+    // a handler that records its id and consumes the value it's interested in, or every one for -1
+    const auto handler = [&order](int id, int interest) {
+        return [&order, id, interest](int v) {
+            order.push_back(id);
+            return interest == -1 || v == interest;
+        };
+    };
+
+    CConsumableSignalT<int> signal;
+    auto                    fallback = signal.listen(handler(0, -1));
+    auto                    popup    = signal.listen(handler(1, 1), 10);
+    auto                    overlay  = signal.listen(handler(2, 0), 20);
+
+    // the popup eats it, the fallback is never asked
+    EXPECT_TRUE(signal.emit(1));
+    EXPECT_EQ(order, (std::vector<int>{2, 1}));
+
+    order.clear();
+    EXPECT_TRUE(signal.emit(2));
+    EXPECT_EQ(order, (std::vector<int>{2, 1, 0}));
+
+    fallback.reset();
+    order.clear();
+    EXPECT_FALSE(signal.emit(2));
+    EXPECT_EQ(order, (std::vector<int>{2, 1}));
+
+    // handlers without arguments work too
+    auto grab = signal.listen([] { return true; }, 100);
+    order.clear();
+    EXPECT_TRUE(signal.emit(2));
+    EXPECT_TRUE(order.empty());
+
+    CConsumableSignalT<int> empty;
+    EXPECT_FALSE(empty.emit(1));
+}
+
+static void instrumentation() {
+    if constexpr (!Hyprutils::Signal::Impl_::INSTRUMENTED)
+        return;
+
+    const auto find = [](const SSignalSnapshot& snapshot, std::string_view name) {
+        const auto IT = std::ranges::find_if(snapshot.signals, [name](const auto& s) { return s.name == name; });
+        return IT == snapshot.signals.end() ? SSignalStats{} : *IT;
+    };
+
+    CSignalT<int> signal;
+    signal.setName("test::instrumented");
+
+    // listeners are recorded under the line they were created on
+    const auto LINE = std::to_string(std::source_location::current().line() + 1);
+    auto       l1   = signal.listen([](int v) { std::this_thread::sleep_for(std::chrono::microseconds(v)); });
+    auto       l2   = signal.listen([] {});
+
+    signal.emit(100);
+    signal.emit(200);
+    l2.reset();
+    signal.emit(0);
+
+    const auto SNAPSHOT = getSignalSnapshot();
+    const auto STATS    = find(SNAPSHOT, "test::instrumented");
+    EXPECT_EQ(STATS.emits, 3);
+    EXPECT_EQ(STATS.calls, 5);
+    EXPECT_EQ(STATS.maxFanOut, 2);
+    EXPECT_GE(STATS.totalNs, 300000);
+    EXPECT_GE(STATS.maxNs, 200000);
+    EXPECT_LE(STATS.maxNs, STATS.totalNs);
+
+    const auto LISTENER = std::ranges::find_if(SNAPSHOT.listeners, [&LINE](const auto& l) { return l.location.ends_with("Signal.cpp:" + LINE); });
+    ASSERT_NE(LISTENER, SNAPSHOT.listeners.end());
+    EXPECT_EQ(LISTENER->calls, 3);
+    EXPECT_GE(LISTENER->maxNs, 200000);
+
+    // the slowest listeners come first
+    EXPECT_TRUE(std::ranges::is_sorted(SNAPSHOT.listeners, std::greater{}, &SListenerStats::totalNs));
+    EXPECT_TRUE(dumpSignalSnapshot(SNAPSHOT).contains("test::instrumented: 3 emits"));
+}
+
 TEST(Signal, signal) {
     legacy();
     legacyListenerEmit();
@@ -366,4 +934,23 @@ TEST(Signal, signal) {
     staticListenerDestroy();
     signalDestroyed();
     listenerDestroysSelf();
+    nestedEmit();
+    signalDestroyedInNestedEmit();
+    signalMoved();
+    signalMovedInEmit();
+    signalNotCopyable();
+    keyed();
+    keyedChurn();
+    deferred();
+    deferredReentrant();
+    deferredDestroyedInFlush();
+    deferredThrowing();
+    crossThread();
+    crossThreadOwner();
+    crossThreadThrowing();
+    memberListener();
+    memberListenerInEmit();
+    priority();
+    consumable();
+    instrumentation();
 }
\ No newline at end of file
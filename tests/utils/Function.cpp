@@ -0,0 +1,123 @@
+#include <hyprutils/utils/Function.hpp>
+#include <hyprutils/utils/ScopeGuard.hpp>
+
+#include <gtest/gtest.h>
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace Hyprutils::Utils;
+
+static int addOne(int x) {
+    return x + 1;
+}
+
+static void testBasics() {
+    CFunction<int(int)> empty;
+    EXPECT_FALSE(empty);
+    EXPECT_TRUE(empty == nullptr);
+
+    CFunction<int(int)> fn = addOne;
+    EXPECT_TRUE(fn);
+    EXPECT_EQ(fn(1), 2);
+
+    int captured = 10;
+    fn           = [&captured](int x) { return x + captured; };
+    EXPECT_EQ(fn(1), 11);
+
+    // null function pointers and empty std::functions are empty
+    int (*nullFn)(int) = nullptr;
+    EXPECT_FALSE(CFunction<int(int)>(nullFn));
+    EXPECT_FALSE(CFunction<int(int)>(std::function<int(int)>{}));
+
+    // a callable that converts to false is still a callable
+    struct SFalsy {
+        int operator()(int x) const {
+            return x;
+        }
+        explicit operator bool() const {
+            return false;
+        }
+    };
+    CFunction<int(int)> falsy = SFalsy{};
+    EXPECT_TRUE(falsy);
+    EXPECT_EQ(falsy(3), 3);
+
+    // the return value is dropped for void
+    CFunction<void(int)> discard = addOne;
+    discard(1);
+
+    // state is kept between calls
+    CFunction<int()> counter = [n = 0]() mutable { return ++n; };
+    counter();
+    EXPECT_EQ(counter(), 2);
+}
+
+static void testMoveOnly() {
+    auto                ptr = std::make_unique<int>(5);
+    CFunction<int()>    fn  = [p = std::move(ptr)] { return *p; };
+    EXPECT_EQ(fn(), 5);
+
+    CFunction<int()> moved = std::move(fn);
+    EXPECT_FALSE(fn);
+    EXPECT_EQ(moved(), 5);
+
+    CFunction<int()> other = [] { return 1; };
+    moved.swap(other);
+    EXPECT_EQ(moved(), 1);
+    EXPECT_EQ(other(), 5);
+
+    other = nullptr;
+    EXPECT_FALSE(other);
+}
+
+static void testStorage() {
+    auto tracker = std::make_shared<int>(0);
+
+    // a big capture goes to the heap, and is released properly
+    {
+        std::array<char, 256> big = {};
+        big[0]                    = 'a';
+        CFunction<char()> fn      = [big, tracker] { return big[0]; };
+        EXPECT_EQ(tracker.use_count(), 2);
+
+        CFunction<char()> moved = std::move(fn);
+        EXPECT_EQ(moved(), 'a');
+        EXPECT_EQ(tracker.use_count(), 2);
+    }
+    EXPECT_EQ(tracker.use_count(), 1);
+
+    // a small one stays inline
+    {
+        CInplaceFunction<int(), 16> fn = [tracker] { return *tracker; };
+        EXPECT_EQ(tracker.use_count(), 2);
+
+        CInplaceFunction<int(), 16> moved = std::move(fn);
+        EXPECT_EQ(tracker.use_count(), 2);
+        moved = nullptr;
+        EXPECT_EQ(tracker.use_count(), 1);
+    }
+
+    static_assert(sizeof(CFunction<void()>) == 64);
+    static_assert(!std::is_copy_constructible_v<CFunction<void()>>);
+    static_assert(!std::is_constructible_v<CFunction<void(int)>, std::string>);
+}
+
+static void testScopeGuard() {
+    int  called = 0;
+
+    auto big = std::make_unique<std::array<int, 64>>();
+    {
+        CScopeGuard guard([&called, b = std::move(big)] { called += (*b)[0] + 1; });
+    }
+
+    EXPECT_EQ(called, 1);
+}
+
+TEST(Utils, function) {
+    testBasics();
+    testMoveOnly();
+    testStorage();
+    testScopeGuard();
+}